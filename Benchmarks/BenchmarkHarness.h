@@ -0,0 +1,204 @@
+#pragma once
+// Shared driver for the headless benchmark executables: option parsing,
+// median-of-repeats timing, JSON output and baseline comparison.
+#include <../Core/Base.h>
+#include <../JSON/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dx3d::bench
+{
+    using json = nlohmann::json;
+    using Clock = std::chrono::steady_clock;
+
+    struct BenchmarkResult
+    {
+        std::string name;
+        ui32 operations = 0;
+        double nsPerOp = 0.0;
+        // Extra measurements written next to ns_per_op, if any
+        json details;
+    };
+
+    struct Options
+    {
+        std::string outputPath;
+        std::string baselinePath;
+        ui32 count = 0;
+        ui32 repeats = 5;
+        double tolerance = 0.10;
+    };
+
+    // Describes one executable: the JSON suite name and what --<countName>
+    // sizes (entities, elements, ...)
+    struct Suite
+    {
+        const char* name;
+        const char* countName;
+        ui32 defaultCount;
+        std::function<std::vector<BenchmarkResult>(const Options&)> run;
+    };
+
+    // Keeps the optimiser from discarding benchmark loops
+    inline volatile float g_sink = 0.0f;
+
+    inline double elapsedNs(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    // setup runs untimed before every repeat; run returns the elapsed time in
+    // nanoseconds of the part being measured
+    inline BenchmarkResult measure(const std::string& name, ui32 operations, ui32 repeats,
+        const std::function<void()>& setup, const std::function<double()>& run)
+    {
+        std::vector<double> samples;
+        samples.reserve(repeats);
+
+        for (ui32 i = 0; i < repeats; ++i)
+        {
+            setup();
+            samples.push_back(run() / operations);
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        BenchmarkResult result;
+        result.name = name;
+        result.operations = operations;
+        result.nsPerOp = samples[samples.size() / 2];
+
+        printf("%-28s %10.2f ns/op  (%u ops)\n", name.c_str(), result.nsPerOp, operations);
+        return result;
+    }
+
+    inline bool parseOptions(int argc, char** argv, const Suite& suite, Options& options)
+    {
+        const std::string countFlag = std::string("--") + suite.countName;
+        options.outputPath = std::string(suite.name) + "_benchmark.json";
+        options.count = suite.defaultCount;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+            if (std::strcmp(arg, "--out") == 0 && value) { options.outputPath = value; ++i; }
+            else if (std::strcmp(arg, "--baseline") == 0 && value) { options.baselinePath = value; ++i; }
+            else if (countFlag == arg && value) { options.count = static_cast<ui32>(std::strtoul(value, nullptr, 10)); ++i; }
+            else if (std::strcmp(arg, "--repeats") == 0 && value) { options.repeats = static_cast<ui32>(std::strtoul(value, nullptr, 10)); ++i; }
+            else if (std::strcmp(arg, "--tolerance") == 0 && value) { options.tolerance = std::strtod(value, nullptr); ++i; }
+            else
+            {
+                printf("Unknown or incomplete argument: %s\n", arg);
+                return false;
+            }
+        }
+
+        if (options.count == 0 || options.repeats == 0)
+        {
+            printf("%s and --repeats must be positive\n", countFlag.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    inline json toJson(const Suite& suite, const Options& options, const std::vector<BenchmarkResult>& results)
+    {
+        json benchmarks = json::array();
+        for (const auto& result : results)
+        {
+            json entry = {
+                {"name", result.name},
+                {"operations", result.operations},
+                {"ns_per_op", result.nsPerOp}
+            };
+            if (!result.details.is_null())
+                entry["details"] = result.details;
+            benchmarks.push_back(entry);
+        }
+
+        return {
+            {"suite", suite.name},
+            {suite.countName, options.count},
+            {"repeats", options.repeats},
+            {"benchmarks", benchmarks}
+        };
+    }
+
+    // Returns the number of benchmarks that regressed past the tolerance, or
+    // -1 if the baseline cannot be read
+    inline int compareWithBaseline(const Options& options, const std::vector<BenchmarkResult>& results)
+    {
+        std::ifstream file(options.baselinePath);
+        if (!file.is_open())
+        {
+            printf("Could not open baseline %s\n", options.baselinePath.c_str());
+            return -1;
+        }
+
+        json baseline = json::parse(file, nullptr, false);
+        if (baseline.is_discarded() || !baseline.contains("benchmarks"))
+        {
+            printf("Baseline %s is not a benchmark result file\n", options.baselinePath.c_str());
+            return -1;
+        }
+
+        int regressions = 0;
+        for (const auto& result : results)
+        {
+            for (const auto& entry : baseline["benchmarks"])
+            {
+                if (entry.value("name", "") != result.name)
+                    continue;
+
+                double reference = entry.value("ns_per_op", 0.0);
+                if (reference > 0.0 && result.nsPerOp > reference * (1.0 + options.tolerance))
+                {
+                    printf("REGRESSION %-20s %.2f ns/op vs baseline %.2f (+%.1f%%)\n",
+                        result.name.c_str(), result.nsPerOp, reference, (result.nsPerOp / reference - 1.0) * 100.0);
+                    regressions++;
+                }
+            }
+        }
+        return regressions;
+    }
+
+    // Whole main(): exit code 0 on success, 1 on a regression against the
+    // baseline, 2 on bad arguments or I/O errors
+    inline int runSuite(int argc, char** argv, const Suite& suite)
+    {
+        Options options;
+        if (!parseOptions(argc, argv, suite, options))
+            return 2;
+
+        printf("%s benchmark: %u %s, %u repeats\n", suite.name, options.count, suite.countName, options.repeats);
+        std::vector<BenchmarkResult> results = suite.run(options);
+
+        std::ofstream output(options.outputPath);
+        if (!output.is_open())
+        {
+            printf("Could not write %s\n", options.outputPath.c_str());
+            return 2;
+        }
+        output << toJson(suite, options, results).dump(2) << "\n";
+        printf("Results written to %s\n", options.outputPath.c_str());
+
+        if (!options.baselinePath.empty())
+        {
+            int regressions = compareWithBaseline(options, results);
+            if (regressions < 0)
+                return 2;
+            if (regressions > 0)
+                return 1;
+        }
+        return 0;
+    }
+}
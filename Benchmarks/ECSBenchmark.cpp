@@ -0,0 +1,271 @@
+// Headless ECS micro-benchmarks. Links only DX3D/ECS, DX3D/Math, the thread
+// pool and the component headers so it runs without a device or window.
+//
+// Usage:
+//   ECSBenchmark [--out results.json] [--entities N] [--repeats N]
+//                [--baseline baseline.json] [--tolerance 0.10]
+//
+// Each benchmark is repeated and the median ns/op is reported. With
+// --baseline, any benchmark slower than baseline * (1 + tolerance) is listed
+// and the process exits with a non-zero code so CI can fail the build.
+#include "BenchmarkHarness.h"
+#include <../ECS/ComponentManager.h>
+#include <../ECS/Components/TransformComponent.h>
+#include <../ECS/TransformHierarchy.h>
+#include <../ECS/SystemScheduler.h>
+#include <../Core/ThreadPool.h>
+#include <random>
+
+using namespace dx3d;
+using namespace dx3d::bench;
+
+namespace
+{
+    // Stand-in for a second hot component in multi-component queries
+    struct VelocityComponent
+    {
+        Vector3 linear{ 0.0f, 0.0f, 0.0f };
+        Vector3 angular{ 0.0f, 0.0f, 0.0f };
+    };
+
+    std::vector<EntityID> populate(ComponentManager& componentManager, ui32 count, bool withVelocity)
+    {
+        std::vector<EntityID> entities;
+        entities.reserve(count);
+
+        componentManager.getComponentArray<TransformComponent>()->reserve(count);
+        if (withVelocity)
+        {
+            componentManager.getComponentArray<VelocityComponent>()->reserve(count);
+        }
+
+        for (ui32 i = 0; i < count; ++i)
+        {
+            EntityID entity = componentManager.createEntity();
+            TransformComponent transform;
+            transform.position = Vector3(static_cast<float>(i), 0.0f, 0.0f);
+            componentManager.addComponent(entity, transform);
+
+            // Every other entity gets a velocity so the view has to filter
+            if (withVelocity && (i & 1) == 0)
+            {
+                componentManager.addComponent(entity, VelocityComponent{ Vector3(1.0f, 0.0f, 0.0f), Vector3() });
+            }
+            entities.push_back(entity);
+        }
+        return entities;
+    }
+
+    std::vector<BenchmarkResult> runBenchmarks(const Options& options)
+    {
+        const ui32 count = options.count;
+        std::vector<BenchmarkResult> results;
+        std::unique_ptr<ComponentManager> componentManager;
+        std::vector<EntityID> entities;
+
+        auto freshWorld = [&]()
+            {
+                componentManager = std::make_unique<ComponentManager>();
+                entities.clear();
+            };
+
+        results.push_back(measure("create_entities", count, options.repeats,
+            [&]()
+            {
+                freshWorld();
+                entities.reserve(count);
+            },
+            [&]()
+            {
+                auto start = Clock::now();
+                for (ui32 i = 0; i < count; ++i)
+                {
+                    entities.push_back(componentManager->createEntity());
+                }
+                return elapsedNs(start, Clock::now());
+            }));
+
+        results.push_back(measure("destroy_entities", count, options.repeats,
+            [&]()
+            {
+                freshWorld();
+                entities = populate(*componentManager, count, false);
+            },
+            [&]()
+            {
+                auto start = Clock::now();
+                for (EntityID entity : entities)
+                {
+                    componentManager->destroyEntity(entity);
+                }
+                return elapsedNs(start, Clock::now());
+            }));
+
+        auto populated = [&]()
+            {
+                if (!componentManager || componentManager->getEntityRegistry().getAliveCount() != count)
+                {
+                    freshWorld();
+                    entities = populate(*componentManager, count, true);
+                }
+            };
+
+        results.push_back(measure("iterate_single", count, options.repeats, populated, [&]()
+            {
+                auto start = Clock::now();
+                float sum = 0.0f;
+                for (auto [entity, transform] : *componentManager->getComponentArray<TransformComponent>())
+                {
+                    sum += transform.position.x;
+                }
+                g_sink = sum;
+                return elapsedNs(start, Clock::now());
+            }));
+
+        results.push_back(measure("iterate_multi", count, options.repeats, populated, [&]()
+            {
+                auto start = Clock::now();
+                componentManager->view<TransformComponent, VelocityComponent>().each(
+                    [](TransformComponent& transform, const VelocityComponent& velocity)
+                    {
+                        transform.position += velocity.linear;
+                    });
+                return elapsedNs(start, Clock::now());
+            }));
+
+        std::vector<EntityID> shuffled;
+        results.push_back(measure("random_access", count, options.repeats,
+            [&]()
+            {
+                populated();
+                shuffled = entities;
+                std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+            },
+            [&]()
+            {
+                auto start = Clock::now();
+                float sum = 0.0f;
+                for (EntityID entity : shuffled)
+                {
+                    sum += componentManager->getComponent<TransformComponent>(entity)->position.x;
+                }
+                g_sink = sum;
+                return elapsedNs(start, Clock::now());
+            }));
+
+        // One op is an add followed by a remove of the same component
+        results.push_back(measure("add_remove_churn", count, options.repeats,
+            [&]()
+            {
+                populated();
+                shuffled = entities;
+                std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(7));
+            },
+            [&]()
+            {
+                auto start = Clock::now();
+                for (EntityID entity : shuffled)
+                {
+                    if (componentManager->hasComponent<VelocityComponent>(entity))
+                    {
+                        componentManager->removeComponent<VelocityComponent>(entity);
+                        componentManager->addComponent(entity, VelocityComponent{});
+                    }
+                    else
+                    {
+                        componentManager->addComponent(entity, VelocityComponent{});
+                        componentManager->removeComponent<VelocityComponent>(entity);
+                    }
+                }
+                return elapsedNs(start, Clock::now());
+            }));
+
+        // Every transform changes each frame; a quarter of the entities are
+        // children so the pass has two depth levels. One op is one entity.
+        ThreadPool threadPool;
+        std::unique_ptr<TransformHierarchy> hierarchy;
+        results.push_back(measure("transform_update_moving", count, options.repeats,
+            [&]()
+            {
+                if (!hierarchy)
+                {
+                    freshWorld();
+                    entities = populate(*componentManager, count, false);
+                    for (ui32 i = 1; i < count; ++i)
+                    {
+                        if (i % 4 == 0)
+                            TransformHierarchy::setParent(*componentManager, entities[i], entities[i - 1]);
+                    }
+                    hierarchy = std::make_unique<TransformHierarchy>();
+                    hierarchy->update(*componentManager, &threadPool);
+                }
+                for (EntityID entity : entities)
+                {
+                    componentManager->patch<TransformComponent>(entity)->position.x += 0.01f;
+                }
+            },
+            [&]()
+            {
+                auto start = Clock::now();
+                hierarchy->update(*componentManager, &threadPool);
+                double ns = elapsedNs(start, Clock::now());
+                g_sink = hierarchy->getWorldMatrices()[count / 2].m[3][0];
+                return ns;
+            }));
+
+        // A frame of three systems through the scheduler: integrate and
+        // damp conflict over velocities, the bounds pass only reads
+        // transforms and waits for integrate. One op is one entity.
+        std::unique_ptr<SystemScheduler> scheduler;
+        results.push_back(measure("scheduled_systems", count, options.repeats,
+            [&]()
+            {
+                if (!scheduler)
+                {
+                    freshWorld();
+                    entities = populate(*componentManager, count, true);
+                    scheduler = std::make_unique<SystemScheduler>(threadPool, *componentManager);
+                    scheduler->addSystem("Integrate", SystemAccess().writes<TransformComponent>().reads<VelocityComponent>(),
+                        [&](float deltaTime)
+                        {
+                            componentManager->view<TransformComponent, VelocityComponent>().each(
+                                [deltaTime](TransformComponent& transform, const VelocityComponent& velocity)
+                                {
+                                    transform.position += velocity.linear * deltaTime;
+                                });
+                        });
+                    scheduler->addSystem("Damp", SystemAccess().writes<VelocityComponent>(),
+                        [&](float deltaTime)
+                        {
+                            for (auto [entity, velocity] : *componentManager->getComponentArray<VelocityComponent>())
+                            {
+                                velocity.linear = velocity.linear * (1.0f - 0.1f * deltaTime);
+                            }
+                        });
+                    scheduler->addSystem("Bounds", SystemAccess().reads<TransformComponent>(),
+                        [&](float)
+                        {
+                            float maxX = 0.0f;
+                            for (auto [entity, transform] : *componentManager->getComponentArray<TransformComponent>())
+                            {
+                                maxX = std::max(maxX, transform.position.x);
+                            }
+                            g_sink = maxX;
+                        });
+                }
+            },
+            [&]()
+            {
+                auto start = Clock::now();
+                scheduler->run(1.0f / 60.0f);
+                return elapsedNs(start, Clock::now());
+            }));
+
+        return results;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    return runSuite(argc, argv, { "ecs", "entities", 1000000, runBenchmarks });
+}
@@ -0,0 +1,160 @@
+// Headless benchmarks for DX3D/Math. Needs no Windows headers, so it also
+// builds with GCC/Clang on Linux (see README).
+//
+// Usage:
+//   MathBenchmark [--out results.json] [--elements N] [--repeats N]
+//                 [--baseline baseline.json] [--tolerance 0.10]
+//
+// The *_reference entries are plain scalar loops kept alongside the SIMD
+// kernels so the speed-up is visible in the same report.
+#include "BenchmarkHarness.h"
+#include <../Math/Math.h>
+#include <../Math/SIMD.h>
+#include <random>
+
+using namespace dx3d;
+using namespace dx3d::bench;
+
+namespace
+{
+    Matrix4x4 multiplyReference(const Matrix4x4& a, const Matrix4x4& b)
+    {
+        Matrix4x4 result;
+        for (int i = 0; i < 4; i++)
+            for (int j = 0; j < 4; j++)
+            {
+                float sum = 0.0f;
+                for (int k = 0; k < 4; k++)
+                    sum += a.m[i][k] * b.m[k][j];
+                result.m[i][j] = sum;
+            }
+        return result;
+    }
+
+    // The pre-SIMD TransformComponent path: five matrices, four multiplies
+    Matrix4x4 composeReference(const Vector3& position, const Vector3& rotation, const Vector3& scale)
+    {
+        Matrix4x4 result = multiplyReference(Matrix4x4::CreateScale(scale), Matrix4x4::CreateRotationZ(rotation.z));
+        result = multiplyReference(result, Matrix4x4::CreateRotationY(rotation.y));
+        result = multiplyReference(result, Matrix4x4::CreateRotationX(rotation.x));
+        return multiplyReference(result, Matrix4x4::CreateTranslation(position));
+    }
+
+    float checksum(const std::vector<Matrix4x4>& matrices)
+    {
+        float sum = 0.0f;
+        for (const auto& matrix : matrices)
+            sum += matrix.m[3][0] + matrix.m[0][0];
+        return sum;
+    }
+
+    std::vector<BenchmarkResult> runBenchmarks(const Options& options)
+    {
+        const ui32 count = options.count;
+        std::vector<BenchmarkResult> results;
+
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+
+        std::vector<Vector3> positions(count), rotations(count), scales(count), points(count), transformed(count);
+        std::vector<Matrix4x4> a(count), b(count), out(count);
+        // TransformComponent layout split per component for the SoA kernel
+        std::vector<float> components[10];
+        for (auto& component : components)
+            component.resize(count);
+
+        for (ui32 i = 0; i < count; ++i)
+        {
+            positions[i] = Vector3(value(random), value(random), value(random));
+            rotations[i] = Vector3(value(random), value(random), value(random));
+            scales[i] = Vector3(1.0f + value(random) * 0.25f, 1.0f, 1.0f);
+
+            const Quaternion rotation = Quaternion::FromEuler(rotations[i]);
+            const float values[10] = { positions[i].x, positions[i].y, positions[i].z,
+                rotation.x, rotation.y, rotation.z, rotation.w, scales[i].x, scales[i].y, scales[i].z };
+            for (int k = 0; k < 10; k++)
+                components[k][i] = values[k];
+
+            points[i] = Vector3(value(random), value(random), value(random));
+            a[i] = Matrix4x4::CreateTransform(positions[i], rotations[i], scales[i]);
+            b[i] = Matrix4x4::CreateTransform(points[i], positions[i], Vector3(1.0f, 1.0f, 1.0f));
+        }
+
+        auto noSetup = []() {};
+        auto timed = [&](const std::function<void()>& body)
+            {
+                auto start = Clock::now();
+                body();
+                double ns = elapsedNs(start, Clock::now());
+                g_sink = checksum(out);
+                return ns;
+            };
+
+        results.push_back(measure("multiply_reference", count, options.repeats, noSetup, [&]()
+            {
+                return timed([&]() { for (ui32 i = 0; i < count; ++i) out[i] = multiplyReference(a[i], b[i]); });
+            }));
+
+        results.push_back(measure("multiply", count, options.repeats, noSetup, [&]()
+            {
+                return timed([&]() { for (ui32 i = 0; i < count; ++i) out[i] = a[i] * b[i]; });
+            }));
+
+        results.push_back(measure("multiply_batch", count, options.repeats, noSetup, [&]()
+            {
+                return timed([&]() { simd::multiply(a.data(), b.data(), out.data(), count); });
+            }));
+
+        results.push_back(measure("multiply_batch_shared", count, options.repeats, noSetup, [&]()
+            {
+                return timed([&]() { simd::multiply(a.data(), b[0], out.data(), count); });
+            }));
+
+        results.push_back(measure("compose_reference", count, options.repeats, noSetup, [&]()
+            {
+                return timed([&]() { for (ui32 i = 0; i < count; ++i) out[i] = composeReference(positions[i], rotations[i], scales[i]); });
+            }));
+
+        results.push_back(measure("compose_batch", count, options.repeats, noSetup, [&]()
+            {
+                return timed([&]() { simd::composeTransforms(positions.data(), rotations.data(), scales.data(), out.data(), count); });
+            }));
+
+        const simd::TransformArrays arrays = {
+            { components[0].data(), components[1].data(), components[2].data() },
+            { components[3].data(), components[4].data(), components[5].data(), components[6].data() },
+            { components[7].data(), components[8].data(), components[9].data() } };
+
+        results.push_back(measure("compose_quaternion_soa", count, options.repeats, noSetup, [&]()
+            {
+                return timed([&]() { simd::composeTransforms(arrays, out.data(), count); });
+            }));
+
+        results.push_back(measure("transpose_batch", count, options.repeats, noSetup, [&]()
+            {
+                return timed([&]() { simd::transpose(a.data(), out.data(), count); });
+            }));
+
+        results.push_back(measure("inverse", count, options.repeats, noSetup, [&]()
+            {
+                return timed([&]() { for (ui32 i = 0; i < count; ++i) out[i] = Matrix4x4::Inverse(a[i]); });
+            }));
+
+        results.push_back(measure("transform_points_batch", count, options.repeats, noSetup, [&]()
+            {
+                auto start = Clock::now();
+                simd::transformPoints(a[0], points.data(), transformed.data(), count);
+                double ns = elapsedNs(start, Clock::now());
+                g_sink = transformed[count / 2].x;
+                return ns;
+            }));
+
+        return results;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    printf("SIMD backend: %s\n", simd::backendName());
+    return runSuite(argc, argv, { "math", "elements", 1000000, runBenchmarks });
+}
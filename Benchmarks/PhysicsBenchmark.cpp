@@ -0,0 +1,548 @@
+// Headless physics stress benchmarks. Drives PhysicsSystem and rp3d without
+// a device or window, so it runs on Linux as a performance regression gate.
+//
+// Usage:
+//   PhysicsBenchmark [--out results.json] [--bodies N] [--repeats N]
+//                    [--baseline baseline.json] [--tolerance 0.10]
+//
+// Every scenario is built on a fresh world each repeat and stepped a fixed
+// number of times; ns/op is the median wall time of one PhysicsSystem::step.
+// --bodies sizes the random pile and the other scenarios scale from it.
+// streamed_terrain lands bodies on a heightfield far larger than they need,
+// so its time includes creating and evicting terrain tiles.
+// Each result also carries the setup time, the bytes rp3d held at its peak
+// during setup and during the steps, and, when ReactPhysics3D was built with
+// IS_RP3D_PROFILING_ENABLED, the average time per step of each phase.
+#include "BenchmarkHarness.h"
+#include <../ECS/ComponentManager.h>
+#include <../ECS/Components/TransformComponent.h>
+#include <../Physics/PhysicsSystem.h>
+#include <cmath>
+#include <random>
+
+using namespace dx3d;
+using namespace dx3d::bench;
+
+namespace
+{
+    constexpr ui32 MEASURED_STEPS = 120;
+    // Sleeping worlds are stepped until every body sleeps, or this many steps
+    constexpr ui32 MAX_SETTLE_STEPS = 1200;
+    constexpr ui32 CHAIN_LINKS = 20;
+
+    // rp3d's base allocator. Its pools and heap take memory from here in
+    // large blocks and keep it, so the peak is what the world reserved.
+    class CountingAllocator : public rp3d::MemoryAllocator
+    {
+    public:
+        void* allocate(size_t size) override
+        {
+            m_current += size;
+            m_peak = std::max(m_peak, m_current);
+            return std::malloc(size);
+        }
+
+        void release(void* pointer, size_t size) override
+        {
+            m_current -= size;
+            std::free(pointer);
+        }
+
+        size_t getPeak() const { return m_peak; }
+        void resetPeak() { m_peak = m_current; }
+
+    private:
+        size_t m_current = 0;
+        size_t m_peak = 0;
+    };
+
+    // One repeat of a scenario: an ECS and the physics world kept in sync with it
+    struct Scene
+    {
+        ComponentManager componentManager;
+        PhysicsSystem physics;
+
+        explicit Scene(rp3d::MemoryAllocator* allocator) :
+            physics(componentManager, allocator)
+        {
+            physics.setRecordingEnabled(false);
+            physics.initialize();
+
+#ifdef IS_RP3D_PROFILING_ENABLED
+            // Otherwise rp3d writes its own report when the world goes away
+            physics.getPhysicsWorld()->getProfiler()->removeAllDestinations();
+#endif
+        }
+
+        EntityID spawn(const Vector3& position, const Quaternion& rotation, const PhysicsComponent& component)
+        {
+            EntityID entity = componentManager.createEntity();
+            TransformComponent transform;
+            transform.position = position;
+            transform.rotation = rotation;
+            componentManager.addComponent(entity, transform);
+            physics.addPhysicsComponent(entity, component);
+            return entity;
+        }
+
+        void addGround(float halfExtent)
+        {
+            PhysicsComponent ground;
+            ground.bodyType = PhysicsBodyType::Static;
+            ground.boxHalfExtents = Vector3(halfExtent, 0.5f, halfExtent);
+            spawn(Vector3(0.0f, -0.5f, 0.0f), Quaternion(), ground);
+        }
+
+        ui32 countSleeping()
+        {
+            rp3d::PhysicsWorld* world = physics.getPhysicsWorld();
+            ui32 sleeping = 0;
+            for (rp3d::uint32 i = 0; i < world->getNbRigidBodies(); ++i)
+            {
+                const rp3d::RigidBody* body = world->getRigidBody(i);
+                if (body->getType() == rp3d::BodyType::DYNAMIC && body->isSleeping())
+                    sleeping++;
+            }
+            return sleeping;
+        }
+    };
+
+    struct Scenario
+    {
+        const char* name;
+        void (*build)(Scene& scene, ui32 bodies);
+        bool settle;
+    };
+
+    // A single wall of boxes, about a tenth of the body count, stacked so
+    // every box rests on two below it
+    void buildPyramid(Scene& scene, ui32 bodies)
+    {
+        scene.addGround(100.0f);
+
+        const float target = std::max(1.0f, bodies / 10.0f);
+        const ui32 base = std::max(1u, static_cast<ui32>((std::sqrt(8.0f * target + 1.0f) - 1.0f) * 0.5f));
+
+        PhysicsComponent box;
+        for (ui32 row = 0; row < base; ++row)
+        {
+            const ui32 count = base - row;
+            for (ui32 i = 0; i < count; ++i)
+            {
+                float x = (static_cast<float>(i) - (count - 1) * 0.5f) * 1.0f;
+                scene.spawn(Vector3(x, 0.5f + row * 1.001f, 0.0f), Quaternion(), box);
+            }
+        }
+    }
+
+    // Boxes, spheres and capsules in a jittered column with random
+    // orientations, collapsing onto the ground
+    void buildPile(Scene& scene, ui32 bodies)
+    {
+        scene.addGround(200.0f);
+
+        std::mt19937 gen(1234);
+        std::uniform_real_distribution<float> jitter(-0.2f, 0.2f);
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        // A few discrete sizes, as a scene of loaded models would have, so
+        // the shape cache is exercised the way it is in play mode
+        const float sizes[] = { 0.3f, 0.4f, 0.5f };
+        std::uniform_int_distribution<int> size(0, 2);
+        std::uniform_int_distribution<int> shape(0, 2);
+
+        const ui32 side = std::max(1u, static_cast<ui32>(std::sqrt(bodies / 20.0f)));
+        const float spacing = 1.5f;
+
+        for (ui32 i = 0; i < bodies; ++i)
+        {
+            ui32 layer = i / (side * side);
+            ui32 cell = i % (side * side);
+            Vector3 position(
+                (static_cast<float>(cell % side) - side * 0.5f) * spacing + jitter(gen),
+                1.0f + layer * spacing,
+                (static_cast<float>(cell / side) - side * 0.5f) * spacing + jitter(gen));
+
+            PhysicsComponent component;
+            float extent = sizes[size(gen)];
+            switch (shape(gen))
+            {
+            case 0:
+                component.shapeType = CollisionShapeType::Box;
+                component.boxHalfExtents = Vector3(extent, extent, extent);
+                break;
+            case 1:
+                component.shapeType = CollisionShapeType::Sphere;
+                component.sphereRadius = extent;
+                break;
+            default:
+                component.shapeType = CollisionShapeType::Capsule;
+                component.capsuleRadius = extent * 0.5f;
+                component.capsuleHeight = extent;
+                break;
+            }
+
+            scene.spawn(position, Quaternion::FromEuler(Vector3(angle(gen), angle(gen), angle(gen))), component);
+        }
+    }
+
+    // Spheres, a tenth of the body count, dropped into a static bowl made of
+    // a triangle mesh, so every contact goes through the concave middle phase
+    void buildSphereRain(Scene& scene, ui32 bodies)
+    {
+        constexpr ui32 cells = 48;
+        constexpr float cellSize = 1.0f;
+        constexpr float half = cells * cellSize * 0.5f;
+
+        auto bowl = std::make_shared<CollisionMesh>();
+        bowl->sourcePath = "benchmark://bowl";
+        for (ui32 z = 0; z <= cells; ++z)
+        {
+            for (ui32 x = 0; x <= cells; ++x)
+            {
+                float px = x * cellSize - half;
+                float pz = z * cellSize - half;
+                bowl->positions.push_back(Vector3(px, 0.02f * (px * px + pz * pz), pz));
+            }
+        }
+        for (ui32 z = 0; z < cells; ++z)
+        {
+            for (ui32 x = 0; x < cells; ++x)
+            {
+                ui32 i = z * (cells + 1) + x;
+                bowl->indices.insert(bowl->indices.end(), { i, i + cells + 1, i + 1, i + 1, i + cells + 1, i + cells + 2 });
+            }
+        }
+        bowl->boundsMin = Vector3(-half, 0.0f, -half);
+        bowl->boundsMax = Vector3(half, 0.04f * half * half, half);
+
+        PhysicsComponent ground;
+        ground.bodyType = PhysicsBodyType::Static;
+        ground.shapeType = CollisionShapeType::TriangleMesh;
+        ground.collisionMesh = bowl;
+        scene.spawn(Vector3(), Quaternion(), ground);
+
+        std::mt19937 gen(5678);
+        std::uniform_real_distribution<float> jitter(-0.1f, 0.1f);
+
+        const ui32 spheres = std::max(1u, bodies / 10);
+        const ui32 side = std::max(1u, static_cast<ui32>(std::sqrt(spheres / 4.0f)));
+
+        PhysicsComponent sphere;
+        sphere.shapeType = CollisionShapeType::Sphere;
+        sphere.sphereRadius = 0.4f;
+        for (ui32 i = 0; i < spheres; ++i)
+        {
+            ui32 layer = i / (side * side);
+            ui32 cell = i % (side * side);
+            Vector3 position(
+                (static_cast<float>(cell % side) - side * 0.5f) + jitter(gen),
+                8.0f + layer * 1.0f,
+                (static_cast<float>(cell / side) - side * 0.5f) + jitter(gen));
+            scene.spawn(position, Quaternion(), sphere);
+        }
+    }
+
+    // Horizontal chains of spheres joined by ball-and-socket joints, hung
+    // from a static first link and swinging down
+    void buildJointChains(Scene& scene, ui32 bodies)
+    {
+        const ui32 chains = std::max(1u, bodies / 100);
+        const ui32 columns = std::max(1u, static_cast<ui32>(std::sqrt(static_cast<float>(chains))));
+        const float linkSpacing = 0.5f;
+
+        PhysicsComponent link;
+        link.shapeType = CollisionShapeType::Sphere;
+        link.sphereRadius = 0.2f;
+
+        std::vector<EntityID> entities;
+        entities.reserve(chains * CHAIN_LINKS);
+        for (ui32 chain = 0; chain < chains; ++chain)
+        {
+            float x = (chain % columns) * (CHAIN_LINKS * linkSpacing + 1.0f);
+            float z = (chain / columns) * 1.0f;
+            for (ui32 i = 0; i < CHAIN_LINKS; ++i)
+            {
+                link.bodyType = (i == 0) ? PhysicsBodyType::Static : PhysicsBodyType::Dynamic;
+                entities.push_back(scene.spawn(Vector3(x + i * linkSpacing, 20.0f, z), Quaternion(), link));
+            }
+        }
+
+        // Joints are not part of PhysicsSystem yet, so they go on the rp3d
+        // bodies directly; each body carries its entity as user data
+        rp3d::PhysicsWorld* world = scene.physics.getPhysicsWorld();
+        std::unordered_map<EntityID, rp3d::RigidBody*> rigidBodies;
+        for (rp3d::uint32 i = 0; i < world->getNbRigidBodies(); ++i)
+        {
+            rp3d::RigidBody* body = world->getRigidBody(i);
+            rigidBodies[static_cast<EntityID>(reinterpret_cast<uintptr_t>(body->getUserData()))] = body;
+        }
+
+        for (size_t i = 0; i < entities.size(); ++i)
+        {
+            if (i % CHAIN_LINKS == 0)
+                continue;
+
+            rp3d::RigidBody* previous = rigidBodies[entities[i - 1]];
+            rp3d::RigidBody* current = rigidBodies[entities[i]];
+            rp3d::Vector3 anchor = (previous->getTransform().getPosition() + current->getTransform().getPosition()) * 0.5f;
+            world->createJoint(rp3d::BallAndSocketJointInfo(previous, current, anchor));
+        }
+    }
+
+    // Boxes, a tenth of the body count, scattered over rolling heightfield
+    // terrain much larger than any of them needs, so the tiles around each
+    // body are streamed in as they land and the rest is never built
+    void buildTerrain(Scene& scene, ui32 bodies)
+    {
+        constexpr ui32 samples = 1025;
+        constexpr float cellSize = 1.0f;
+        constexpr float half = (samples - 1) * cellSize * 0.5f;
+
+        auto heightMap = std::make_shared<HeightMap>();
+        heightMap->columns = samples;
+        heightMap->rows = samples;
+        heightMap->cellSizeX = cellSize;
+        heightMap->cellSizeZ = cellSize;
+        heightMap->origin = Vector3(-half, 0.0f, -half);
+        heightMap->heights.resize(static_cast<size_t>(samples) * samples);
+
+        auto heightAt = [&](float x, float z) { return 3.0f * std::sin(x * 0.05f) * std::cos(z * 0.07f); };
+        for (ui32 row = 0; row < samples; ++row)
+        {
+            for (ui32 column = 0; column < samples; ++column)
+            {
+                heightMap->heights[row * samples + column] = heightAt(column * cellSize - half, row * cellSize - half);
+            }
+        }
+
+        EntityID ground = scene.componentManager.createEntity();
+        scene.componentManager.addComponent(ground, TransformComponent());
+        TerrainComponent terrain;
+        terrain.heightMap = heightMap;
+        scene.physics.addTerrain(ground, terrain);
+
+        std::mt19937 gen(4321);
+        std::uniform_real_distribution<float> spread(-half * 0.9f, half * 0.9f);
+
+        PhysicsComponent box;
+        const ui32 boxes = std::max(1u, bodies / 10);
+        for (ui32 i = 0; i < boxes; ++i)
+        {
+            float x = spread(gen);
+            float z = spread(gen);
+            scene.spawn(Vector3(x, heightAt(x, z) + 2.0f, z), Quaternion(), box);
+        }
+    }
+
+    // Half the body count resting apart on the ground, settled until asleep
+    // before timing, so this measures what a quiet world costs per step
+    void buildSleepingWorld(Scene& scene, ui32 bodies)
+    {
+        scene.addGround(400.0f);
+
+        const ui32 boxes = std::max(1u, bodies / 2);
+        const ui32 side = std::max(1u, static_cast<ui32>(std::ceil(std::sqrt(static_cast<float>(boxes)))));
+
+        PhysicsComponent box;
+        for (ui32 i = 0; i < boxes; ++i)
+        {
+            Vector3 position(
+                (static_cast<float>(i % side) - side * 0.5f) * 2.0f,
+                0.5f,
+                (static_cast<float>(i / side) - side * 0.5f) * 2.0f);
+            scene.spawn(position, Quaternion(), box);
+        }
+    }
+
+#ifdef IS_RP3D_PROFILING_ENABLED
+    // rp3d profiler blocks summed into the phases reported per step
+    struct Phase
+    {
+        const char* name;
+        std::vector<const char*> blocks;
+        double milliseconds = 0.0;
+    };
+
+    std::vector<Phase> makePhases()
+    {
+        return {
+            { "broad", { "CollisionDetectionSystem::computeBroadPhase()", "BroadPhaseSystem::updateColliders()" } },
+            { "middle", { "CollisionDetectionSystem::computeMiddlePhase()" } },
+            { "narrow", { "CollisionDetectionSystem::computeNarrowPhase()", "CollisionDetectionSystem::createContacts()" } },
+            { "islands", { "PhysicsWorld::createIslands()" } },
+            { "solver", { "PhysicsWorld::solveContactsAndConstraints()", "PhysicsWorld::solvePositionCorrection()" } },
+            { "integrate", { "DynamicsSystem::integrateRigidBodiesVelocities()",
+                "DynamicsSystem::integrateRigidBodiesPositions()", "DynamicsSystem::updateBodiesState()" } },
+            { "sleeping", { "PhysicsWorld::updateSleepingBodies()" } }
+        };
+    }
+
+    // Walks the children of the iterator's node. A block that belongs to a
+    // phase is added whole; any other is searched for phase blocks below it.
+    void collectPhases(rp3d::ProfileNodeIterator* iterator, std::vector<Phase>& phases, double& update)
+    {
+        for (int child = 0; ; ++child)
+        {
+            iterator->first();
+            for (int i = 0; i < child && !iterator->isEnd(); ++i)
+            {
+                iterator->next();
+            }
+            if (iterator->isEnd())
+                return;
+
+            const char* name = iterator->getCurrentName();
+            double milliseconds = iterator->getCurrentTotalTime().count();
+
+            bool matched = false;
+            for (Phase& phase : phases)
+            {
+                for (const char* block : phase.blocks)
+                {
+                    if (std::strcmp(block, name) == 0)
+                    {
+                        phase.milliseconds += milliseconds;
+                        matched = true;
+                    }
+                }
+            }
+            if (matched)
+                continue;
+
+            if (std::strcmp(name, "PhysicsWorld::update()") == 0)
+                update += milliseconds;
+
+            iterator->enterChild(child);
+            collectPhases(iterator, phases, update);
+            iterator->enterParent();
+        }
+    }
+#endif
+
+    BenchmarkResult runScenario(const Scenario& scenario, const Options& options)
+    {
+        std::vector<double> stepSamples;
+        std::vector<double> setupSamples;
+        size_t setupPeak = 0;
+        size_t stepPeak = 0;
+        ui32 bodyCount = 0;
+        ui32 sleeping = 0;
+
+#ifdef IS_RP3D_PROFILING_ENABLED
+        std::vector<Phase> phases = makePhases();
+        double update = 0.0;
+        double stepped = 0.0;
+#endif
+
+        for (ui32 repeat = 0; repeat < options.repeats; ++repeat)
+        {
+            // Outlives the scene, whose rp3d memory goes back to it
+            CountingAllocator allocator;
+            Scene scene(&allocator);
+
+            auto start = Clock::now();
+            scenario.build(scene, options.count);
+            setupSamples.push_back(elapsedNs(start, Clock::now()) / 1e6);
+            setupPeak = std::max(setupPeak, allocator.getPeak());
+
+            if (scenario.settle)
+            {
+                ui32 dynamic = scene.physics.getPhysicsWorld()->getNbRigidBodies() - 1;
+                for (ui32 i = 0; i < MAX_SETTLE_STEPS && scene.countSleeping() < dynamic; ++i)
+                {
+                    scene.physics.step();
+                }
+            }
+
+            allocator.resetPeak();
+#ifdef IS_RP3D_PROFILING_ENABLED
+            rp3d::Profiler* profiler = scene.physics.getPhysicsWorld()->getProfiler();
+            profiler->reset();
+#endif
+
+            start = Clock::now();
+            for (ui32 i = 0; i < MEASURED_STEPS; ++i)
+            {
+                scene.physics.step();
+            }
+            double elapsed = elapsedNs(start, Clock::now());
+            stepSamples.push_back(elapsed / MEASURED_STEPS);
+
+            stepPeak = std::max(stepPeak, allocator.getPeak());
+            bodyCount = scene.physics.getPhysicsWorld()->getNbRigidBodies();
+            sleeping = scene.countSleeping();
+
+#ifdef IS_RP3D_PROFILING_ENABLED
+            // getIterator() hands out a new iterator; destroyIterator() is private
+            std::unique_ptr<rp3d::ProfileNodeIterator> iterator(profiler->getIterator());
+            collectPhases(iterator.get(), phases, update);
+            stepped += elapsed / 1e6;
+#endif
+        }
+
+        std::sort(stepSamples.begin(), stepSamples.end());
+        std::sort(setupSamples.begin(), setupSamples.end());
+
+        BenchmarkResult result;
+        result.name = scenario.name;
+        result.operations = MEASURED_STEPS;
+        result.nsPerOp = stepSamples[stepSamples.size() / 2];
+        result.details = {
+            {"bodies", bodyCount},
+            {"sleeping_bodies", sleeping},
+            {"setup_ms", setupSamples[setupSamples.size() / 2]},
+            {"setup_peak_bytes", setupPeak},
+            {"step_peak_bytes", stepPeak}
+        };
+
+        printf("%-28s %10.2f ns/op  (%u bodies, setup %.1f ms, peak %.1f MB)\n", result.name.c_str(), result.nsPerOp,
+            bodyCount, setupSamples[setupSamples.size() / 2], std::max(setupPeak, stepPeak) / (1024.0 * 1024.0));
+
+#ifdef IS_RP3D_PROFILING_ENABLED
+        // Milliseconds per step. "other" is the rest of rp3d's update and
+        // "sync" what PhysicsSystem adds around it: snapshots and transforms.
+        const double steps = static_cast<double>(MEASURED_STEPS) * options.repeats;
+        json phaseTimes = json::object();
+        double accounted = 0.0;
+        for (const Phase& phase : phases)
+        {
+            phaseTimes[phase.name] = phase.milliseconds / steps;
+            accounted += phase.milliseconds;
+            printf("    %-12s %8.3f ms\n", phase.name, phase.milliseconds / steps);
+        }
+        phaseTimes["other"] = std::max(0.0, update - accounted) / steps;
+        phaseTimes["sync"] = std::max(0.0, stepped - update) / steps;
+        result.details["phases_ms"] = phaseTimes;
+#endif
+
+        return result;
+    }
+
+    std::vector<BenchmarkResult> runBenchmarks(const Options& options)
+    {
+        const Scenario scenarios[] = {
+            { "box_pyramid", buildPyramid, false },
+            { "random_pile", buildPile, false },
+            { "sphere_rain_concave", buildSphereRain, false },
+            { "joint_chains", buildJointChains, false },
+            { "streamed_terrain", buildTerrain, false },
+            { "sleeping_world", buildSleepingWorld, true }
+        };
+
+#ifndef IS_RP3D_PROFILING_ENABLED
+        printf("ReactPhysics3D was built without IS_RP3D_PROFILING_ENABLED; phase timings are not reported\n");
+#endif
+
+        std::vector<BenchmarkResult> results;
+        for (const Scenario& scenario : scenarios)
+        {
+            results.push_back(runScenario(scenario, options));
+        }
+        return results;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    return runSuite(argc, argv, { "physics", "bodies", 10000, runBenchmarks });
+}
@@ -0,0 +1,155 @@
+// Headless replay of a physics recording, as saved by "Save Physics Log" in
+// the scene controls or PhysicsSystem::saveRecording. Links only the physics,
+// ECS and math sources plus ReactPhysics3D, so it runs without a device or
+// window and can profile a scene captured in play mode.
+//
+// Usage:
+//   PhysicsReplay <recording.dxpr> [--out report.json] [--repeats N] [--spikes N]
+//
+// Every repeat replays the whole log on a fresh world. The report lists the
+// median total time and the slowest runs of steps, which is where a spike
+// seen in play mode shows up. Recordings that start from an empty world are
+// checked against their per-step checksums; the process exits with 1 if the
+// replay diverged, 2 on bad arguments or I/O errors and 0 otherwise.
+#include "BenchmarkHarness.h"
+#include <../ECS/ComponentManager.h>
+#include <../Physics/PhysicsSystem.h>
+
+using namespace dx3d;
+using namespace dx3d::bench;
+
+namespace
+{
+    struct StepTiming
+    {
+        std::uint64_t firstStep = 0;
+        ui32 steps = 0;
+        double milliseconds = 0.0;
+    };
+
+    struct ReplayOptions
+    {
+        std::string recordingPath;
+        std::string outputPath = "physics_replay.json";
+        ui32 repeats = 3;
+        ui32 spikes = 10;
+    };
+
+    bool parseReplayOptions(int argc, char** argv, ReplayOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+            if (std::strcmp(arg, "--out") == 0 && value) { options.outputPath = value; ++i; }
+            else if (std::strcmp(arg, "--repeats") == 0 && value) { options.repeats = static_cast<ui32>(std::strtoul(value, nullptr, 10)); ++i; }
+            else if (std::strcmp(arg, "--spikes") == 0 && value) { options.spikes = static_cast<ui32>(std::strtoul(value, nullptr, 10)); ++i; }
+            else if (arg[0] != '-' && options.recordingPath.empty()) { options.recordingPath = arg; }
+            else
+            {
+                printf("Unknown or incomplete argument: %s\n", arg);
+                return false;
+            }
+        }
+
+        if (options.recordingPath.empty() || options.repeats == 0)
+        {
+            printf("Usage: PhysicsReplay <recording.dxpr> [--out report.json] [--repeats N] [--spikes N]\n");
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ReplayOptions options;
+    if (!parseReplayOptions(argc, argv, options))
+        return 2;
+
+    ComponentManager componentManager;
+    PhysicsSystem physicsSystem(componentManager);
+    physicsSystem.initialize();
+
+    ReplayReport report;
+    std::vector<double> totals;
+    std::vector<StepTiming> timings;
+
+    for (ui32 repeat = 0; repeat < options.repeats; ++repeat)
+    {
+        std::vector<StepTiming> runTimings;
+        std::uint64_t stepsSoFar = 0;
+        double total = 0.0;
+
+        bool replayed = physicsSystem.replay(options.recordingPath, report,
+            [&](ui32 steps, double milliseconds)
+            {
+                runTimings.push_back({ stepsSoFar, steps, milliseconds });
+                stepsSoFar += steps;
+                total += milliseconds;
+            });
+
+        if (!replayed)
+            return 2;
+
+        printf("Repeat %u: %llu steps in %.2f ms\n", repeat + 1, static_cast<unsigned long long>(report.steps), total);
+        totals.push_back(total);
+        if (repeat == 0)
+            timings = std::move(runTimings);
+    }
+
+    std::vector<double> sortedTotals = totals;
+    std::sort(sortedTotals.begin(), sortedTotals.end());
+    double medianTotal = sortedTotals[sortedTotals.size() / 2];
+
+    std::sort(timings.begin(), timings.end(),
+        [](const StepTiming& a, const StepTiming& b) { return a.milliseconds > b.milliseconds; });
+    timings.resize(std::min<size_t>(timings.size(), options.spikes));
+
+    json spikes = json::array();
+    for (const auto& timing : timings)
+    {
+        printf("  step %-8llu x%u  %8.3f ms\n", static_cast<unsigned long long>(timing.firstStep), timing.steps, timing.milliseconds);
+        spikes.push_back({
+            {"first_step", timing.firstStep},
+            {"steps", timing.steps},
+            {"ms", timing.milliseconds}
+            });
+    }
+
+    if (report.exact)
+    {
+        printf("Checksums: %llu compared, %llu mismatched\n",
+            static_cast<unsigned long long>(report.checksumsCompared), static_cast<unsigned long long>(report.mismatches));
+        if (report.mismatches > 0)
+            printf("First divergence after step %llu\n", static_cast<unsigned long long>(report.firstMismatchStep));
+    }
+    else
+    {
+        printf("Recording starts from a keyframe; checksums not compared\n");
+    }
+
+    json output = {
+        {"recording", options.recordingPath},
+        {"steps", report.steps},
+        {"exact", report.exact},
+        {"checksums_compared", report.checksumsCompared},
+        {"mismatches", report.mismatches},
+        {"first_mismatch_step", report.firstMismatchStep},
+        {"repeat_ms", totals},
+        {"median_ms", medianTotal},
+        {"slowest", spikes}
+    };
+
+    std::ofstream file(options.outputPath);
+    if (!file.is_open())
+    {
+        printf("Could not write %s\n", options.outputPath.c_str());
+        return 2;
+    }
+    file << output.dump(2) << "\n";
+    printf("Report written to %s\n", options.outputPath.c_str());
+
+    return report.mismatches > 0 ? 1 : 0;
+}
@@ -8,6 +8,57 @@
 using namespace dx3d;
 
 std::unordered_map<std::string, std::shared_ptr<Material>> ModelParser::m_materialRegistry;
+std::unordered_map<std::string, std::shared_ptr<const CollisionMesh>> ModelParser::m_collisionMeshRegistry;
+
+namespace
+{
+    // Every triangle of the file over the shared OBJ positions, so the
+    // collider keeps the file's vertex welding instead of the per-corner
+    // copies the render meshes use
+    std::shared_ptr<const CollisionMesh> buildCollisionMesh(
+        const std::string& path,
+        const tinyobj::attrib_t& attributes,
+        const std::vector<tinyobj::shape_t>& shapes)
+    {
+        auto collisionMesh = std::make_shared<CollisionMesh>();
+        collisionMesh->sourcePath = path;
+
+        size_t vertexCount = attributes.vertices.size() / 3;
+        collisionMesh->positions.reserve(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++) {
+            Vector3 position(
+                attributes.vertices[3 * i + 0],
+                attributes.vertices[3 * i + 1],
+                attributes.vertices[3 * i + 2]);
+
+            collisionMesh->boundsMin = (i == 0) ? position : Vector3::Min(collisionMesh->boundsMin, position);
+            collisionMesh->boundsMax = (i == 0) ? position : Vector3::Max(collisionMesh->boundsMax, position);
+            collisionMesh->positions.push_back(position);
+        }
+
+        for (const auto& shapeData : shapes) {
+            size_t offset = 0;
+            for (size_t j = 0; j < shapeData.mesh.num_face_vertices.size(); j++) {
+                size_t numVerts = shapeData.mesh.num_face_vertices[j];
+
+                // Triangulated on load, so anything else is degenerate
+                if (numVerts == 3 && offset + 3 <= shapeData.mesh.indices.size()) {
+                    int a = shapeData.mesh.indices[offset + 0].vertex_index;
+                    int b = shapeData.mesh.indices[offset + 1].vertex_index;
+                    int c = shapeData.mesh.indices[offset + 2].vertex_index;
+                    if (a >= 0 && b >= 0 && c >= 0 && a != b && b != c && a != c) {
+                        collisionMesh->indices.push_back(static_cast<ui32>(a));
+                        collisionMesh->indices.push_back(static_cast<ui32>(b));
+                        collisionMesh->indices.push_back(static_cast<ui32>(c));
+                    }
+                }
+                offset += numVerts;
+            }
+        }
+
+        return collisionMesh;
+    }
+}
 
 std::shared_ptr<Model> ModelParser::LoadModel(
     const std::string& path,
@@ -211,6 +262,12 @@ bool ModelParser::parseOBJ(
             return false;
         }
 
+        auto& collisionMesh = m_collisionMeshRegistry[absolutePath];
+        if (!collisionMesh) {
+            collisionMesh = buildCollisionMesh(absolutePath, attributes, geometry);
+        }
+        asset->setCollisionMesh(collisionMesh);
+
         std::vector<std::shared_ptr<Material>> materials;
         for (const auto& mat : materialData) {
             try {
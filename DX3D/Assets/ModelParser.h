@@ -26,13 +26,16 @@ namespace dx3d
             const GraphicsResourceDesc& resDesc
         );
 
-        static std::string findAssetPath(const std::string& path);
         static std::string extractDirectory(const std::string& path);
         static std::shared_ptr<Model> generateDefaultModel(const GraphicsResourceDesc& resDesc);
 
         static std::unordered_map<std::string, std::shared_ptr<Material>> m_materialRegistry;
+        static std::unordered_map<std::string, std::shared_ptr<const CollisionMesh>> m_collisionMeshRegistry;
 
     public:
+        // Where a model file name given to LoadModel is read from
+        static std::string findAssetPath(const std::string& path);
+
         static std::shared_ptr<Model> LoadModel(
             const std::string& path,
             const GraphicsResourceDesc& resDesc
@@ -0,0 +1,135 @@
+#include <../Core/ThreadPool.h>
+#include <algorithm>
+
+using namespace dx3d;
+
+namespace
+{
+    // Slots are per pool, so the owning pool is kept next to the slot
+    thread_local const ThreadPool* t_threadPool = nullptr;
+    thread_local ui32 t_threadSlot = 0;
+}
+
+ThreadPool::ThreadPool(ui32 workerCount)
+{
+    if (workerCount == 0)
+    {
+        ui32 hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    m_workers.reserve(workerCount);
+    for (ui32 i = 0; i < workerCount; ++i)
+    {
+        m_workers.emplace_back([this, i]() { workerLoop(i + 1); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+void ThreadPool::submit(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_condition.notify_one();
+}
+
+bool ThreadPool::tryRunPendingJob()
+{
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_jobs.empty())
+            return false;
+
+        job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+    }
+
+    job();
+    return true;
+}
+
+void ThreadPool::parallelFor(ui32 count, ui32 grainSize, const std::function<void(ui32, ui32)>& func)
+{
+    if (count == 0)
+        return;
+
+    grainSize = std::max(grainSize, 1u);
+    ui32 chunkCount = (count + grainSize - 1) / grainSize;
+
+    if (chunkCount == 1 || m_workers.empty())
+    {
+        func(0, count);
+        return;
+    }
+
+    std::atomic<ui32> remaining{ chunkCount - 1 };
+
+    for (ui32 chunk = 1; chunk < chunkCount; ++chunk)
+    {
+        ui32 begin = chunk * grainSize;
+        ui32 end = std::min(begin + grainSize, count);
+        submit([&func, &remaining, begin, end]()
+            {
+                func(begin, end);
+                remaining.fetch_sub(1, std::memory_order_release);
+            });
+    }
+
+    func(0, std::min(grainSize, count));
+
+    while (remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (!tryRunPendingJob())
+            std::this_thread::yield();
+    }
+}
+
+ui32 ThreadPool::getCurrentThreadSlot() const
+{
+    return t_threadPool == this ? t_threadSlot : 0;
+}
+
+const ThreadPool* ThreadPool::getCurrentPool()
+{
+    return t_threadPool;
+}
+
+void ThreadPool::workerLoop(ui32 slot)
+{
+    t_threadPool = this;
+    t_threadSlot = slot;
+
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+
+            if (m_stopping && m_jobs.empty())
+                return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        job();
+    }
+}
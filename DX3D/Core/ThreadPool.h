@@ -0,0 +1,59 @@
+#pragma once
+#include <../Core/Common.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dx3d
+{
+    // Fixed set of worker threads pulling jobs from a shared queue. Threads
+    // that wait on work (parallelFor, SystemScheduler) help drain the queue
+    // instead of blocking, so nested parallel calls from inside a job are safe.
+    class ThreadPool
+    {
+    public:
+        using Job = std::function<void()>;
+
+        // workerCount == 0 picks hardware_concurrency - 1 (the caller is the extra thread)
+        explicit ThreadPool(ui32 workerCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(Job job);
+
+        // Runs one queued job on the calling thread; returns false if the queue was empty
+        bool tryRunPendingJob();
+
+        // Splits [0, count) into chunks of at most grainSize and runs
+        // func(begin, end) for each, using the caller as one of the workers.
+        // Returns once every chunk has finished.
+        void parallelFor(ui32 count, ui32 grainSize, const std::function<void(ui32, ui32)>& func);
+
+        ui32 getWorkerCount() const { return static_cast<ui32>(m_workers.size()); }
+
+        // Number of distinct thread slots: every worker plus the non-worker callers (slot 0)
+        ui32 getThreadSlotCount() const { return getWorkerCount() + 1; }
+
+        // 0 on any thread that is not one of this pool's workers, 1..N on workers
+        ui32 getCurrentThreadSlot() const;
+
+        // Pool the calling thread is a worker of; nullptr on any other thread
+        static const ThreadPool* getCurrentPool();
+
+    private:
+        void workerLoop(ui32 slot);
+
+    private:
+        std::vector<std::thread> m_workers;
+        std::deque<Job> m_jobs;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stopping = false;
+    };
+}
@@ -0,0 +1,44 @@
+#include <../ECS/CommandBuffer.h>
+
+using namespace dx3d;
+
+PendingEntity CommandBuffer::createEntity()
+{
+    return PendingEntity{ m_pendingEntityCount++ };
+}
+
+void CommandBuffer::destroyEntity(EntityID entity)
+{
+    m_destroyedEntities.push_back(entity);
+}
+
+void CommandBuffer::flush(ComponentManager& componentManager, std::vector<EntityID>* createdEntities)
+{
+    m_createdScratch.clear();
+    m_createdScratch.reserve(m_pendingEntityCount);
+    for (ui32 i = 0; i < m_pendingEntityCount; ++i)
+    {
+        m_createdScratch.push_back(componentManager.createEntity());
+    }
+
+    for (ComponentTypeID typeID : m_usedBatches)
+    {
+        m_batches[typeID]->apply(componentManager, m_createdScratch);
+        m_batches[typeID]->clear();
+        m_batchUsed[typeID] = false;
+    }
+
+    for (EntityID entity : m_destroyedEntities)
+    {
+        componentManager.destroyEntity(entity);
+    }
+
+    if (createdEntities)
+    {
+        createdEntities->insert(createdEntities->end(), m_createdScratch.begin(), m_createdScratch.end());
+    }
+
+    m_usedBatches.clear();
+    m_destroyedEntities.clear();
+    m_pendingEntityCount = 0;
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include "../ECS/ComponentManager.h"
+#include <memory>
+#include <vector>
+
+namespace dx3d
+{
+    // Entity created through a CommandBuffer; only usable with that same
+    // buffer until it is flushed and a real EntityID has been assigned.
+    struct PendingEntity
+    {
+        ui32 index = ~0u;
+    };
+
+    // Records structural ECS changes (create/destroy entities, add/remove
+    // components) so they can be applied at a sync point instead of while a
+    // pool is being iterated. On flush, entities are created first, then the
+    // component operations of each type are applied in recorded order with one
+    // reservation per pool, then entities are destroyed.
+    //
+    // A CommandBuffer is not thread-safe; give each thread its own
+    // (SystemScheduler::getCommandBuffer does that for scheduled systems).
+    class CommandBuffer
+    {
+    public:
+        PendingEntity createEntity();
+        void destroyEntity(EntityID entity);
+
+        template<typename T>
+        void addComponent(EntityID entity, T component)
+        {
+            getBatch<T>().add(EntityRef{ entity, ~0u }, std::move(component));
+        }
+
+        template<typename T>
+        void addComponent(PendingEntity entity, T component)
+        {
+            getBatch<T>().add(EntityRef{ INVALID_ENTITY, entity.index }, std::move(component));
+        }
+
+        template<typename T>
+        void removeComponent(EntityID entity)
+        {
+            getBatch<T>().remove(EntityRef{ entity, ~0u });
+        }
+
+        // Applies every recorded command and clears the buffer, keeping its
+        // allocations for the next frame. Entities created by this flush are
+        // appended to createdEntities (in PendingEntity order) if given.
+        void flush(ComponentManager& componentManager, std::vector<EntityID>* createdEntities = nullptr);
+
+        bool empty() const { return m_pendingEntityCount == 0 && m_destroyedEntities.empty() && m_usedBatches.empty(); }
+
+    private:
+        struct EntityRef
+        {
+            EntityID entity;
+            ui32 pendingIndex;
+
+            EntityID resolve(const std::vector<EntityID>& created) const
+            {
+                return pendingIndex != ~0u ? created[pendingIndex] : entity;
+            }
+        };
+
+        class ICommandBatch
+        {
+        public:
+            virtual ~ICommandBatch() = default;
+            virtual void apply(ComponentManager& componentManager, const std::vector<EntityID>& created) = 0;
+            virtual void clear() = 0;
+        };
+
+        template<typename T>
+        class CommandBatch : public ICommandBatch
+        {
+        public:
+            void add(const EntityRef& target, T component)
+            {
+                m_operations.push_back({ target, static_cast<ui32>(m_values.size()) });
+                m_values.push_back(std::move(component));
+            }
+
+            void remove(const EntityRef& target)
+            {
+                m_operations.push_back({ target, REMOVE_OPERATION });
+            }
+
+            void apply(ComponentManager& componentManager, const std::vector<EntityID>& created) override
+            {
+                ComponentArray<T>* pool = componentManager.getComponentArray<T>();
+                pool->reserveAdditional(m_values.size());
+
+                for (const Operation& operation : m_operations)
+                {
+                    EntityID entity = operation.target.resolve(created);
+                    if (operation.valueIndex == REMOVE_OPERATION)
+                    {
+                        pool->removeComponent(entity);
+                    }
+                    else if (componentManager.isAlive(entity))
+                    {
+                        pool->addComponent(entity, std::move(m_values[operation.valueIndex]));
+                    }
+                }
+            }
+
+            void clear() override
+            {
+                m_operations.clear();
+                m_values.clear();
+            }
+
+        private:
+            static constexpr ui32 REMOVE_OPERATION = ~0u;
+
+            struct Operation
+            {
+                EntityRef target;
+                ui32 valueIndex;
+            };
+
+            std::vector<Operation> m_operations;
+            std::vector<T> m_values;
+        };
+
+        template<typename T>
+        CommandBatch<T>& getBatch()
+        {
+            ComponentTypeID typeID = getComponentTypeID<T>();
+            if (typeID >= m_batches.size())
+            {
+                m_batches.resize(static_cast<size_t>(typeID) + 1);
+                m_batchUsed.resize(static_cast<size_t>(typeID) + 1, false);
+            }
+
+            auto& batch = m_batches[typeID];
+            if (!batch)
+            {
+                batch = std::make_unique<CommandBatch<T>>();
+            }
+
+            if (!m_batchUsed[typeID])
+            {
+                m_batchUsed[typeID] = true;
+                m_usedBatches.push_back(typeID);
+            }
+            return static_cast<CommandBatch<T>&>(*batch);
+        }
+
+    private:
+        // Indexed by ComponentTypeID; batches are kept across flushes so
+        // their vectors retain capacity.
+        std::vector<std::unique_ptr<ICommandBatch>> m_batches;
+        std::vector<bool> m_batchUsed;
+        std::vector<ComponentTypeID> m_usedBatches;
+
+        ui32 m_pendingEntityCount = 0;
+        std::vector<EntityID> m_destroyedEntities;
+        std::vector<EntityID> m_createdScratch;
+    };
+}
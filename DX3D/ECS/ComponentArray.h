@@ -0,0 +1,247 @@
+#pragma once
+#include "../ECS/Entity.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+namespace dx3d
+{
+    constexpr ui32 INVALID_COMPONENT_INDEX = ~0u;
+
+    // Monotonic per-pool change counter. 64 bits so it never wraps in practice
+    // even when every component of a large pool is touched each frame.
+    using ComponentVersion = std::uint64_t;
+
+    class IComponentArray
+    {
+    public:
+        virtual ~IComponentArray() = default;
+        virtual void removeEntity(EntityID entity) = 0;
+        virtual bool containsEntity(EntityID entity) const = 0;
+        virtual ComponentVersion getVersion() const = 0;
+    };
+
+    // Sparse-set storage: components are packed contiguously in m_components,
+    // m_dense holds the owning entity of each slot and m_sparse maps an entity
+    // index back to its slot. Removal swaps the last element into the hole so the
+    // packed arrays never contain gaps.
+    //
+    // Every slot also carries the pool version at which it was last written.
+    // Adding a component and markChanged() stamp the slot with a fresh version;
+    // removals only bump the pool version. Consumers remember getVersion() after
+    // processing and later ask for slots whose version is greater than that.
+    // Writing through a plain getComponent() pointer is not tracked, so code
+    // that mutates tracked data must call markChanged() (or use
+    // ComponentManager::patch). Like structural changes, marking is not
+    // thread-safe; the scheduler already serialises writers of a pool.
+    template<typename T>
+    class ComponentArray : public IComponentArray
+    {
+    public:
+        template<typename Component>
+        class BasicIterator
+        {
+        public:
+            using value_type = std::pair<EntityID, Component&>;
+
+            BasicIterator(const EntityID* entity, Component* component) : m_entity(entity), m_component(component) {}
+
+            value_type operator*() const { return value_type(*m_entity, *m_component); }
+            BasicIterator& operator++() { ++m_entity; ++m_component; return *this; }
+            bool operator==(const BasicIterator& other) const { return m_entity == other.m_entity; }
+            bool operator!=(const BasicIterator& other) const { return m_entity != other.m_entity; }
+
+        private:
+            const EntityID* m_entity;
+            Component* m_component;
+        };
+
+        using Iterator = BasicIterator<T>;
+        using ConstIterator = BasicIterator<const T>;
+
+        static constexpr ui32 INVALID_INDEX = INVALID_COMPONENT_INDEX;
+
+        void addComponent(EntityID entity, T component)
+        {
+            ui32 index = getIndex(entity);
+            if (index != INVALID_INDEX)
+            {
+                m_components[index] = std::move(component);
+                m_changeVersions[index] = ++m_version;
+                return;
+            }
+
+            ui32 entityIndex = getEntityIndex(entity);
+            if (entityIndex >= m_sparse.size())
+            {
+                m_sparse.resize(static_cast<size_t>(entityIndex) + 1, INVALID_INDEX);
+            }
+            else if (m_sparse[entityIndex] != INVALID_INDEX)
+            {
+                // Slot is still held by an older generation of this index
+                removeComponent(m_dense[m_sparse[entityIndex]]);
+            }
+
+            m_sparse[entityIndex] = static_cast<ui32>(m_dense.size());
+            m_dense.push_back(entity);
+            m_components.push_back(std::move(component));
+            m_changeVersions.push_back(++m_version);
+            m_structureVersion = m_version;
+        }
+
+        void removeComponent(EntityID entity)
+        {
+            ui32 index = getIndex(entity);
+            if (index == INVALID_INDEX)
+                return;
+
+            ui32 last = static_cast<ui32>(m_dense.size() - 1);
+            if (index != last)
+            {
+                EntityID movedEntity = m_dense[last];
+                m_dense[index] = movedEntity;
+                m_components[index] = std::move(m_components[last]);
+                m_changeVersions[index] = m_changeVersions[last];
+                m_sparse[getEntityIndex(movedEntity)] = index;
+            }
+
+            m_dense.pop_back();
+            m_components.pop_back();
+            m_changeVersions.pop_back();
+            m_sparse[getEntityIndex(entity)] = INVALID_INDEX;
+            m_structureVersion = ++m_version;
+        }
+
+        // Flags the entity's component as modified. Returns false if the
+        // entity has no component in this pool.
+        bool markChanged(EntityID entity)
+        {
+            ui32 index = getIndex(entity);
+            if (index == INVALID_INDEX)
+                return false;
+
+            m_changeVersions[index] = ++m_version;
+            return true;
+        }
+
+        // Current pool version; changes whenever any component is added,
+        // removed or marked changed
+        ComponentVersion getVersion() const override { return m_version; }
+
+        // Pool version of the last add or remove. Dense slots, and therefore
+        // getIndex() results, stay valid while this is unchanged.
+        ComponentVersion getStructureVersion() const { return m_structureVersion; }
+
+        // Version at which the entity's component was last written, or 0 if
+        // it has none. Never 0 for a present component.
+        ComponentVersion getChangeVersion(EntityID entity) const
+        {
+            ui32 index = getIndex(entity);
+            return (index != INVALID_INDEX) ? m_changeVersions[index] : 0;
+        }
+
+        bool changedSince(EntityID entity, ComponentVersion version) const
+        {
+            return getChangeVersion(entity) > version;
+        }
+
+        // func is called as func(EntityID, T&) for every component written
+        // after version. Callbacks must not add or remove components here.
+        template<typename Func>
+        void eachChangedSince(ComponentVersion version, Func&& func)
+        {
+            if (version >= m_version)
+                return;
+
+            for (size_t i = 0; i < m_dense.size(); ++i)
+            {
+                if (m_changeVersions[i] > version)
+                {
+                    func(m_dense[i], m_components[i]);
+                }
+            }
+        }
+
+        T* getComponent(EntityID entity)
+        {
+            ui32 index = getIndex(entity);
+            return (index != INVALID_INDEX) ? &m_components[index] : nullptr;
+        }
+
+        const T* getComponent(EntityID entity) const
+        {
+            ui32 index = getIndex(entity);
+            return (index != INVALID_INDEX) ? &m_components[index] : nullptr;
+        }
+
+        bool hasComponent(EntityID entity) const
+        {
+            return getIndex(entity) != INVALID_INDEX;
+        }
+
+        void removeEntity(EntityID entity) override
+        {
+            removeComponent(entity);
+        }
+
+        bool containsEntity(EntityID entity) const override
+        {
+            return hasComponent(entity);
+        }
+
+        // Dense slot of an entity, or INVALID_INDEX if it has no component.
+        // The sparse index is keyed by entity index only; comparing the full
+        // handle stored in the dense array rejects stale generations.
+        ui32 getIndex(EntityID entity) const
+        {
+            ui32 entityIndex = getEntityIndex(entity);
+            if (entityIndex >= m_sparse.size())
+                return INVALID_INDEX;
+
+            ui32 index = m_sparse[entityIndex];
+            return (index != INVALID_INDEX && m_dense[index] == entity) ? index : INVALID_INDEX;
+        }
+
+        void reserve(size_t capacity)
+        {
+            m_dense.reserve(capacity);
+            m_components.reserve(capacity);
+            m_changeVersions.reserve(capacity);
+        }
+
+        // Makes room for count more components, growing geometrically so
+        // repeated batched inserts stay amortised O(1)
+        void reserveAdditional(size_t count)
+        {
+            size_t required = m_dense.size() + count;
+            if (required > m_dense.capacity())
+            {
+                reserve(std::max(required, m_dense.capacity() * 2));
+            }
+        }
+
+        size_t size() const { return m_dense.size(); }
+        bool empty() const { return m_dense.empty(); }
+
+        // Packed views, index-aligned with each other
+        const std::vector<EntityID>& getEntities() const { return m_dense; }
+        T* data() { return m_components.data(); }
+        const T* data() const { return m_components.data(); }
+        const ComponentVersion* changeVersions() const { return m_changeVersions.data(); }
+
+        Iterator begin() { return Iterator(m_dense.data(), m_components.data()); }
+        Iterator end() { return Iterator(m_dense.data() + m_dense.size(), m_components.data() + m_components.size()); }
+
+        ConstIterator begin() const { return ConstIterator(m_dense.data(), m_components.data()); }
+        ConstIterator end() const { return ConstIterator(m_dense.data() + m_dense.size(), m_components.data() + m_components.size()); }
+
+    private:
+        std::vector<ui32> m_sparse;
+        std::vector<EntityID> m_dense;
+        std::vector<T> m_components;
+        std::vector<ComponentVersion> m_changeVersions;
+        ComponentVersion m_version = 0;
+        ComponentVersion m_structureVersion = 0;
+    };
+}
@@ -1,105 +1,119 @@
 #pragma once
 #include "../ECS/Entity.h"
-#include <unordered_map>
+#include "../ECS/EntityRegistry.h"
+#include "../ECS/ComponentArray.h"
+#include "../ECS/ComponentType.h"
+#include "../ECS/View.h"
+#include <vector>
 #include <memory>
-#include <typeindex>
 
 namespace dx3d
 {
-    class IComponentArray
-    {
-    public:
-        virtual ~IComponentArray() = default;
-        virtual void removeEntity(EntityID entity) = 0;
-    };
-
-    template<typename T>
-    class ComponentArray : public IComponentArray
+    class ComponentManager
     {
     public:
-        void addComponent(EntityID entity, T component)
+        // Pools of the calling thread's current World (see Scene/World.h).
+        // Prefer passing a ComponentManager& where one is available.
+        static ComponentManager& getInstance();
+
+        ComponentManager() = default;
+        ComponentManager(const ComponentManager&) = delete;
+        ComponentManager& operator=(const ComponentManager&) = delete;
+
+        // Pools are created lazily on first use, which resizes the pool table
+        // and so is not safe while other threads read it. Register every type
+        // before systems run in parallel; SystemScheduler::addSystem does so
+        // for the types a system declares.
+        template<typename T>
+        void registerComponent()
         {
-            m_components[entity] = std::move(component);
+            getComponentArray<T>();
         }
 
-        void removeComponent(EntityID entity)
+        EntityID createEntity()
         {
-            m_components.erase(entity);
+            return m_entityRegistry.create();
         }
 
-        T* getComponent(EntityID entity)
+        // Removes every component of the entity and recycles its index.
+        // Handles to it held elsewhere become stale and stop resolving.
+        void destroyEntity(EntityID entity)
         {
-            auto it = m_components.find(entity);
-            return (it != m_components.end()) ? &it->second : nullptr;
+            if (!m_entityRegistry.isAlive(entity))
+                return;
+
+            removeEntity(entity);
+            m_entityRegistry.destroy(entity);
         }
 
-        // FIX: Add const version
-        const T* getComponent(EntityID entity) const
+        bool isAlive(EntityID entity) const
         {
-            auto it = m_components.find(entity);
-            return (it != m_components.end()) ? &it->second : nullptr;
+            return m_entityRegistry.isAlive(entity);
         }
 
-        bool hasComponent(EntityID entity) const
+        const EntityRegistry& getEntityRegistry() const { return m_entityRegistry; }
+
+        template<typename T>
+        void addComponent(EntityID entity, T component)
         {
-            return m_components.find(entity) != m_components.end();
+            if (!m_entityRegistry.isAlive(entity))
+                return;
+
+            getComponentArray<T>()->addComponent(entity, std::move(component));
         }
 
-        void removeEntity(EntityID entity) override
+        template<typename T>
+        void removeComponent(EntityID entity)
         {
-            removeComponent(entity);
+            getComponentArray<T>()->removeComponent(entity);
         }
 
-        auto begin() { return m_components.begin(); }
-        auto end() { return m_components.end(); }
-
-        // FIX: Add const versions
-        auto begin() const { return m_components.begin(); }
-        auto end() const { return m_components.end(); }
-
-    private:
-        std::unordered_map<EntityID, T> m_components;
-    };
-
-    class ComponentManager
-    {
-    public:
-        static ComponentManager& getInstance()
+        template<typename T>
+        T* getComponent(EntityID entity)
         {
-            static ComponentManager instance;
-            return instance;
+            return getComponentArray<T>()->getComponent(entity);
         }
 
         template<typename T>
-        void registerComponent()
+        const T* getComponent(EntityID entity) const
         {
-            std::type_index typeIndex = std::type_index(typeid(T));
-            m_componentArrays[typeIndex] = std::make_unique<ComponentArray<T>>();
+            auto array = getComponentArray<T>();
+            return array ? array->getComponent(entity) : nullptr;
         }
 
+        // Mutable access that also flags the component as changed, for
+        // writers whose consumers use change tracking
         template<typename T>
-        void addComponent(EntityID entity, T component)
+        T* patch(EntityID entity)
         {
-            getComponentArray<T>()->addComponent(entity, std::move(component));
+            auto array = getComponentArray<T>();
+            T* component = array->getComponent(entity);
+            if (component)
+            {
+                array->markChanged(entity);
+            }
+            return component;
         }
 
         template<typename T>
-        void removeComponent(EntityID entity)
+        bool markChanged(EntityID entity)
         {
-            getComponentArray<T>()->removeComponent(entity);
+            return getComponentArray<T>()->markChanged(entity);
         }
 
+        // Version of the T pool; 0 if the pool has never been touched
         template<typename T>
-        T* getComponent(EntityID entity)
+        ComponentVersion getVersion() const
         {
-            return getComponentArray<T>()->getComponent(entity);
+            auto array = getComponentArray<T>();
+            return array ? array->getVersion() : 0;
         }
 
-        // FIX: Add const version
         template<typename T>
-        const T* getComponent(EntityID entity) const
+        ComponentVersion getChangeVersion(EntityID entity) const
         {
-            return getComponentArray<T>()->getComponent(entity);
+            auto array = getComponentArray<T>();
+            return array ? array->getChangeVersion(entity) : 0;
         }
 
         template<typename T>
@@ -112,36 +126,53 @@ namespace dx3d
         template<typename T>
         ComponentArray<T>* getComponentArray()
         {
-            std::type_index typeIndex = std::type_index(typeid(T));
-            auto it = m_componentArrays.find(typeIndex);
-            if (it != m_componentArrays.end())
+            ComponentTypeID typeID = getComponentTypeID<T>();
+            if (typeID >= m_componentArrays.size())
             {
-                return static_cast<ComponentArray<T>*>(it->second.get());
+                m_componentArrays.resize(static_cast<size_t>(typeID) + 1);
             }
-            return nullptr;
+
+            auto& array = m_componentArrays[typeID];
+            if (!array)
+            {
+                array = std::make_unique<ComponentArray<T>>();
+            }
+            return static_cast<ComponentArray<T>*>(array.get());
         }
 
         template<typename T>
         const ComponentArray<T>* getComponentArray() const
         {
-            std::type_index typeIndex = std::type_index(typeid(T));
-            auto it = m_componentArrays.find(typeIndex);
-            if (it != m_componentArrays.end())
+            ComponentTypeID typeID = getComponentTypeID<T>();
+            if (typeID < m_componentArrays.size())
             {
-                return static_cast<const ComponentArray<T>*>(it->second.get());
+                return static_cast<const ComponentArray<T>*>(m_componentArrays[typeID].get());
             }
             return nullptr;
         }
 
+        // Multi-component query, e.g.
+        // view<TransformComponent, PhysicsComponent>().each([](EntityID e, TransformComponent& t, PhysicsComponent& p) { ... });
+        template<typename... Components, typename... Excluded>
+        View<Components...> view(Exclude<Excluded...> = {})
+        {
+            return View<Components...>(getComponentArray<Components>()..., { getComponentArray<Excluded>()... });
+        }
+
         void removeEntity(EntityID entity)
         {
-            for (auto& pair : m_componentArrays)
+            for (auto& array : m_componentArrays)
             {
-                pair.second->removeEntity(entity);
+                if (array)
+                {
+                    array->removeEntity(entity);
+                }
             }
         }
 
     private:
-        std::unordered_map<std::type_index, std::unique_ptr<IComponentArray>> m_componentArrays;
+        EntityRegistry m_entityRegistry;
+        // Indexed by ComponentTypeID
+        std::vector<std::unique_ptr<IComponentArray>> m_componentArrays;
     };
 }
\ No newline at end of file
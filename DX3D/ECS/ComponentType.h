@@ -0,0 +1,27 @@
+#pragma once
+#include "../Core/Base.h"
+#include <atomic>
+
+namespace dx3d
+{
+    using ComponentTypeID = ui32;
+
+    namespace detail
+    {
+        inline ComponentTypeID allocateComponentTypeID()
+        {
+            static std::atomic<ComponentTypeID> s_nextID{ 0 };
+            return s_nextID.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Dense per-type ID, assigned the first time a component type is used.
+    // IDs are process-wide and stable for the lifetime of the program, so
+    // they can index pool arrays directly.
+    template<typename T>
+    ComponentTypeID getComponentTypeID()
+    {
+        static const ComponentTypeID s_id = detail::allocateComponentTypeID();
+        return s_id;
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "../ECS/Entity.h"
+
+namespace dx3d
+{
+    // Parent/child links stored in the ECS. Children of an entity form a
+    // doubly linked sibling list starting at firstChild, so relinking never
+    // allocates. Edit through TransformHierarchy to keep depth consistent.
+    struct HierarchyComponent
+    {
+        EntityID parent = INVALID_ENTITY;
+        EntityID firstChild = INVALID_ENTITY;
+        EntityID nextSibling = INVALID_ENTITY;
+        EntityID prevSibling = INVALID_ENTITY;
+        ui32 childCount = 0;
+        ui32 depth = 0; // 0 for roots
+    };
+}
@@ -1,7 +1,8 @@
 #pragma once
 #include "../Math/Math.h"
-#include <reactphysics3d/reactphysics3d.h>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace dx3d
 {
@@ -18,14 +19,29 @@ namespace dx3d
         Sphere,
         Cylinder,
         Capsule,
-        Plane
+        Plane,
+        // Built from a CollisionMesh. Triangle meshes are only supported on
+        // static and kinematic bodies; dynamic ones use the convex hull.
+        ConvexHull,
+        TriangleMesh
     };
 
-    struct PhysicsComponent
+    // Indexed triangles of a loaded model, shared by every instance of the
+    // file. Immutable once built, so it can be handed to the physics thread.
+    struct CollisionMesh
     {
-        rp3d::RigidBody* rigidBody = nullptr;
-        rp3d::Collider* collider = nullptr;
+        // Key for the baked rp3d meshes, which are built once per file
+        std::string sourcePath;
+        std::vector<Vector3> positions;
+        std::vector<ui32> indices;
+        Vector3 boundsMin;
+        Vector3 boundsMax;
+    };
 
+    // Description of an entity's rigid body. The rp3d body itself is owned
+    // by PhysicsSystem, which may live on another thread.
+    struct PhysicsComponent
+    {
         PhysicsBodyType bodyType = PhysicsBodyType::Dynamic;
         CollisionShapeType shapeType = CollisionShapeType::Box;
 
@@ -36,12 +52,21 @@ namespace dx3d
         float cylinderHeight = 1.0f;
         float capsuleRadius = 0.5f;
         float capsuleHeight = 1.0f;
+        std::shared_ptr<const CollisionMesh> collisionMesh;
+        Vector3 meshScale{ 1.0f, 1.0f, 1.0f };
 
         // Physics properties
         float mass = 1.0f;
         float restitution = 0.3f;  // Bounciness (0-1)
         float friction = 0.5f;     // Surface friction (0-1)
 
-        bool isInitialized = false;
+        // Triggers report overlaps instead of colliding
+        bool isTrigger = false;
+        // Collision events are only recorded for pairs where either side
+        // has a tag in PhysicsSystem's event filter; 0 never reports
+        ui32 eventTags = 1;
+
+        // Written back by PhysicsSystem with each pose
+        Vector3 linearVelocity{ 0.0f, 0.0f, 0.0f };
     };
 }
\ No newline at end of file
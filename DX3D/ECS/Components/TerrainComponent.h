@@ -0,0 +1,23 @@
+#pragma once
+#include "../Physics/HeightMap.h"
+#include <memory>
+
+namespace dx3d
+{
+    // Heightfield ground collision for an entity. PhysicsSystem cuts the
+    // height map into tiles of tileCells x tileCells cells and only keeps
+    // the tiles within streamRadius of a dynamic body in the rp3d world.
+    struct TerrainComponent
+    {
+        std::shared_ptr<const HeightMap> heightMap;
+
+        ui32 tileCells = 64;
+        float streamRadius = 32.0f;
+
+        float restitution = 0.1f;
+        float friction = 0.8f;
+
+        // See PhysicsComponent::eventTags
+        ui32 eventTags = 1;
+    };
+}
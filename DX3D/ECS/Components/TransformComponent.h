@@ -6,18 +6,16 @@ namespace dx3d
     struct TransformComponent
     {
         Vector3 position{ 0.0f, 0.0f, 0.0f };
-        Vector3 rotation{ 0.0f, 0.0f, 0.0f }; // Euler angles in radians
+        Quaternion rotation; // unit quaternion, identity by default
         Vector3 scale{ 1.0f, 1.0f, 1.0f };
 
+        // Euler view for editor code; the quaternion is authoritative
+        Vector3 getEulerAngles() const { return Quaternion::ToEuler(rotation); }
+        void setEulerAngles(const Vector3& eulerAngles) { rotation = Quaternion::FromEuler(eulerAngles); }
+
         Matrix4x4 getWorldMatrix() const
         {
-            Matrix4x4 scaleMatrix = Matrix4x4::CreateScale(scale);
-            Matrix4x4 rotationX = Matrix4x4::CreateRotationX(rotation.x);
-            Matrix4x4 rotationY = Matrix4x4::CreateRotationY(rotation.y);
-            Matrix4x4 rotationZ = Matrix4x4::CreateRotationZ(rotation.z);
-            Matrix4x4 translationMatrix = Matrix4x4::CreateTranslation(position);
-
-            return scaleMatrix * rotationZ * rotationY * rotationX * translationMatrix;
+            return Matrix4x4::CreateTransform(position, rotation, scale);
         }
     };
 }
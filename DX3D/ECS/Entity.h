@@ -3,9 +3,25 @@
 
 namespace dx3d
 {
+    // An EntityID packs a slot index (low bits) and a generation counter (high
+    // bits). Freed slots are recycled with a bumped generation, so handles to
+    // a destroyed entity never compare equal to the entity now using the slot.
     using EntityID = ui32;
     constexpr EntityID INVALID_ENTITY = 0;
 
+    constexpr ui32 ENTITY_INDEX_BITS = 20;
+    constexpr ui32 ENTITY_GENERATION_BITS = 12;
+    constexpr ui32 ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+    constexpr ui32 ENTITY_GENERATION_MASK = (1u << ENTITY_GENERATION_BITS) - 1;
+    constexpr ui32 MAX_ENTITIES = ENTITY_INDEX_MASK;
+
+    constexpr ui32 getEntityIndex(EntityID entity) { return entity & ENTITY_INDEX_MASK; }
+    constexpr ui32 getEntityGeneration(EntityID entity) { return (entity >> ENTITY_INDEX_BITS) & ENTITY_GENERATION_MASK; }
+    constexpr EntityID makeEntityID(ui32 index, ui32 generation)
+    {
+        return (index & ENTITY_INDEX_MASK) | ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS);
+    }
+
     class Entity
     {
     public:
@@ -13,6 +29,8 @@ namespace dx3d
         explicit Entity(EntityID id) : m_id(id) {}
 
         EntityID getID() const { return m_id; }
+        ui32 getIndex() const { return getEntityIndex(m_id); }
+        ui32 getGeneration() const { return getEntityGeneration(m_id); }
         bool isValid() const { return m_id != INVALID_ENTITY; }
 
         bool operator==(const Entity& other) const { return m_id == other.m_id; }
@@ -21,4 +39,4 @@ namespace dx3d
     private:
         EntityID m_id;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,70 @@
+#include <../ECS/EntityRegistry.h>
+#include <stdexcept>
+
+using namespace dx3d;
+
+EntityRegistry::EntityRegistry()
+{
+    clear();
+}
+
+EntityID EntityRegistry::create()
+{
+    ui32 index = static_cast<ui32>(m_generations.size());
+    bool exhausted = index > MAX_ENTITIES;
+
+    // Oldest free slot first; below the minimum grow instead, unless the
+    // index space is used up
+    if (m_freeIndices.size() >= MIN_FREE_INDICES || (exhausted && !m_freeIndices.empty()))
+    {
+        index = m_freeIndices.front();
+        m_freeIndices.pop_front();
+        m_alive[index] = true;
+        return makeEntityID(index, m_generations[index]);
+    }
+
+    if (exhausted)
+    {
+        throw std::runtime_error("EntityRegistry: entity index space exhausted");
+    }
+
+    m_generations.push_back(0);
+    m_alive.push_back(true);
+    return makeEntityID(index, 0);
+}
+
+void EntityRegistry::destroy(EntityID entity)
+{
+    if (!isAlive(entity))
+        return;
+
+    ui32 index = getEntityIndex(entity);
+    m_alive[index] = false;
+
+    // Wrapping back to generation 0 would revive old handles; retire the slot
+    if (m_generations[index] == ENTITY_GENERATION_MASK)
+    {
+        ++m_retiredCount;
+        return;
+    }
+
+    ++m_generations[index];
+    m_freeIndices.push_back(index);
+}
+
+bool EntityRegistry::isAlive(EntityID entity) const
+{
+    ui32 index = getEntityIndex(entity);
+    if (index == 0 || index >= m_generations.size())
+        return false;
+
+    return m_alive[index] && m_generations[index] == getEntityGeneration(entity);
+}
+
+void EntityRegistry::clear()
+{
+    m_generations.assign(1, 0);
+    m_alive.assign(1, false);
+    m_freeIndices.clear();
+    m_retiredCount = 0;
+}
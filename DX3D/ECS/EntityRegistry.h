@@ -0,0 +1,40 @@
+#pragma once
+#include "../ECS/Entity.h"
+#include <vector>
+#include <deque>
+
+namespace dx3d
+{
+    // Hands out generational entity handles. Destroyed slots go onto a free
+    // list and are reused before new slots are allocated, so the number of
+    // slots (and every array indexed by entity index) stays bounded by the
+    // peak number of live entities rather than the total ever created.
+    //
+    // The free list is FIFO and only drawn from once it holds
+    // MIN_FREE_INDICES slots, so one slot is not recycled back to back and
+    // its generation advances slowly. A slot whose generation reaches
+    // ENTITY_GENERATION_MASK is retired rather than wrapped, so a stale
+    // handle can never become valid again.
+    class EntityRegistry
+    {
+    public:
+        EntityRegistry();
+
+        EntityID create();
+        void destroy(EntityID entity);
+        bool isAlive(EntityID entity) const;
+        void clear();
+
+        size_t getAliveCount() const { return m_generations.size() - 1 - m_freeIndices.size() - m_retiredCount; }
+        size_t getCapacity() const { return m_generations.size() - 1; }
+
+    private:
+        static constexpr size_t MIN_FREE_INDICES = 1024;
+
+        // Current generation of every slot; slot 0 is reserved for INVALID_ENTITY
+        std::vector<ui32> m_generations;
+        std::vector<bool> m_alive;
+        std::deque<ui32> m_freeIndices;
+        size_t m_retiredCount = 0;
+    };
+}
@@ -0,0 +1,231 @@
+#include <../ECS/SystemScheduler.h>
+#include <../Core/ThreadPool.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+using namespace dx3d;
+
+namespace
+{
+    bool intersects(const std::vector<ui32>& a, const std::vector<ui32>& b)
+    {
+        for (ui32 key : a)
+        {
+            if (std::find(b.begin(), b.end(), key) != b.end())
+                return true;
+        }
+        return false;
+    }
+}
+
+bool SystemAccess::conflictsWith(const SystemAccess& other) const
+{
+    if (m_exclusive || other.m_exclusive)
+        return true;
+
+    return intersects(m_writes, other.m_writes) ||
+        intersects(m_writes, other.m_reads) ||
+        intersects(m_reads, other.m_writes);
+}
+
+void SystemAccess::registerPools(ComponentManager& componentManager) const
+{
+    for (auto registerPool : m_pools)
+    {
+        registerPool(componentManager);
+    }
+}
+
+SystemScheduler::SystemScheduler(ThreadPool& threadPool, ComponentManager& componentManager, SystemScope scope) :
+    m_threadPool(threadPool),
+    m_componentManager(componentManager),
+    m_scope(std::move(scope)),
+    m_commandBuffers(threadPool.getThreadSlotCount())
+{
+}
+
+CommandBuffer& SystemScheduler::getCommandBuffer()
+{
+    // Workers of another pool would share slot 0 with this pool's callers
+    const ThreadPool* currentPool = ThreadPool::getCurrentPool();
+    assert(currentPool == nullptr || currentPool == &m_threadPool);
+
+    ui32 slot = m_threadPool.getCurrentThreadSlot();
+    assert(slot < m_commandBuffers.size());
+    return m_commandBuffers[slot];
+}
+
+void SystemScheduler::flushCommandBuffers()
+{
+    for (auto& commandBuffer : m_commandBuffers)
+    {
+        if (!commandBuffer.empty())
+        {
+            commandBuffer.flush(m_componentManager);
+        }
+    }
+}
+
+void SystemScheduler::addSystem(const std::string& name, const SystemAccess& access, SystemFunction function)
+{
+    access.registerPools(m_componentManager);
+
+    SystemEntry entry;
+    entry.name = name;
+    entry.access = access;
+    entry.function = std::move(function);
+    m_systems.push_back(std::move(entry));
+
+    m_graphDirty = true;
+}
+
+void SystemScheduler::buildGraph()
+{
+    for (auto& system : m_systems)
+    {
+        system.dependents.clear();
+        system.dependencyCount = 0;
+    }
+
+    // Every conflicting pair is ordered by registration. Edges implied by a
+    // chain through an intermediate system are kept; they are harmless and
+    // the system count is small.
+    for (ui32 later = 0; later < m_systems.size(); ++later)
+    {
+        for (ui32 earlier = 0; earlier < later; ++earlier)
+        {
+            if (m_systems[later].access.conflictsWith(m_systems[earlier].access))
+            {
+                m_systems[earlier].dependents.push_back(later);
+                m_systems[later].dependencyCount++;
+            }
+        }
+    }
+
+    m_timings.resize(m_systems.size());
+    for (size_t i = 0; i < m_systems.size(); ++i)
+    {
+        m_timings[i].name = m_systems[i].name;
+    }
+
+    m_graphDirty = false;
+}
+
+void SystemScheduler::run(float deltaTime)
+{
+    if (m_graphDirty)
+        buildGraph();
+
+    const ui32 systemCount = static_cast<ui32>(m_systems.size());
+    if (systemCount == 0)
+        return;
+
+    auto runStart = std::chrono::steady_clock::now();
+
+    std::unique_ptr<std::atomic<ui32>[]> remaining(new std::atomic<ui32>[systemCount]);
+    for (ui32 i = 0; i < systemCount; ++i)
+    {
+        remaining[i].store(m_systems[i].dependencyCount, std::memory_order_relaxed);
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<ui32> mainThreadReady;
+    ui32 completed = 0;
+
+    std::function<void(ui32)> dispatch;
+
+    auto execute = [&](ui32 index)
+        {
+            auto start = std::chrono::steady_clock::now();
+            if (m_scope)
+                m_scope([&]() { m_systems[index].function(deltaTime); });
+            else
+                m_systems[index].function(deltaTime);
+            auto end = std::chrono::steady_clock::now();
+
+            m_timings[index].milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+            m_timings[index].threadSlot = m_threadPool.getCurrentThreadSlot();
+
+            for (ui32 dependent : m_systems[index].dependents)
+            {
+                if (remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    dispatch(dependent);
+                }
+            }
+
+            // Notify under the lock: run() may return (destroying these
+            // locals) as soon as it observes the final completion.
+            std::lock_guard<std::mutex> lock(mutex);
+            completed++;
+            condition.notify_all();
+        };
+
+    dispatch = [&](ui32 index)
+        {
+            if (m_systems[index].access.isMainThread())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    mainThreadReady.push_back(index);
+                }
+                condition.notify_all();
+            }
+            else
+            {
+                m_threadPool.submit([&execute, index]() { execute(index); });
+            }
+        };
+
+    for (ui32 i = 0; i < systemCount; ++i)
+    {
+        if (m_systems[i].dependencyCount == 0)
+        {
+            dispatch(i);
+        }
+    }
+
+    while (true)
+    {
+        ui32 mainThreadSystem = ~0u;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (completed == systemCount)
+                break;
+
+            if (!mainThreadReady.empty())
+            {
+                // Lowest index first keeps main-thread systems in registration order
+                auto it = std::min_element(mainThreadReady.begin(), mainThreadReady.end());
+                mainThreadSystem = *it;
+                mainThreadReady.erase(it);
+            }
+        }
+
+        if (mainThreadSystem != ~0u)
+        {
+            execute(mainThreadSystem);
+            continue;
+        }
+
+        if (m_threadPool.tryRunPendingJob())
+            continue;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait_for(lock, std::chrono::microseconds(200), [&]()
+            {
+                return completed == systemCount || !mainThreadReady.empty();
+            });
+    }
+
+    // Sync point: no system is running, structural changes are safe
+    flushCommandBuffers();
+
+    auto runEnd = std::chrono::steady_clock::now();
+    m_lastRunMilliseconds = std::chrono::duration<double, std::milli>(runEnd - runStart).count();
+}
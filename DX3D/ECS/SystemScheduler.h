@@ -0,0 +1,153 @@
+#pragma once
+#include "../ECS/ComponentType.h"
+#include "../ECS/CommandBuffer.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    class ThreadPool;
+
+    namespace detail
+    {
+        inline ui32 allocateResourceTypeID()
+        {
+            static std::atomic<ui32> s_nextID{ 0 };
+            return s_nextID.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // ID for non-component state a system touches (cameras, managers, the
+    // physics world). Kept apart from component IDs so pools stay dense.
+    template<typename T>
+    ui32 getResourceTypeID()
+    {
+        static const ui32 s_id = detail::allocateResourceTypeID();
+        return s_id;
+    }
+
+    // What a system touches. Two systems conflict if one writes something the
+    // other reads or writes; conflicting systems run in registration order,
+    // everything else is free to run concurrently.
+    class SystemAccess
+    {
+    public:
+        template<typename... Components>
+        SystemAccess& reads()
+        {
+            (m_reads.push_back(getComponentTypeID<Components>()), ...);
+            (m_pools.push_back(&registerPool<Components>), ...);
+            return *this;
+        }
+
+        template<typename... Components>
+        SystemAccess& writes()
+        {
+            (m_writes.push_back(getComponentTypeID<Components>()), ...);
+            (m_pools.push_back(&registerPool<Components>), ...);
+            return *this;
+        }
+
+        template<typename... Resources>
+        SystemAccess& readsResource() { (m_reads.push_back(RESOURCE_KEY_BIT | getResourceTypeID<Resources>()), ...); return *this; }
+
+        template<typename... Resources>
+        SystemAccess& writesResource() { (m_writes.push_back(RESOURCE_KEY_BIT | getResourceTypeID<Resources>()), ...); return *this; }
+
+        // Conflicts with every other system (opaque code with unknown access)
+        SystemAccess& exclusive() { m_exclusive = true; return *this; }
+
+        // Must run on the thread that calls SystemScheduler::run (Win32, ImGui, D3D)
+        SystemAccess& mainThread() { m_mainThread = true; return *this; }
+
+        bool isExclusive() const { return m_exclusive; }
+        bool isMainThread() const { return m_mainThread; }
+        bool conflictsWith(const SystemAccess& other) const;
+
+        // Creates the pool of every declared component type, so none is
+        // created lazily while systems run concurrently
+        void registerPools(ComponentManager& componentManager) const;
+
+    private:
+        static constexpr ui32 RESOURCE_KEY_BIT = 0x80000000u;
+
+        template<typename T>
+        static void registerPool(ComponentManager& componentManager) { componentManager.registerComponent<T>(); }
+
+        std::vector<ui32> m_reads;
+        std::vector<ui32> m_writes;
+        std::vector<void (*)(ComponentManager&)> m_pools;
+        bool m_exclusive = false;
+        bool m_mainThread = false;
+    };
+
+    // Runs registered systems once per frame. A dependency graph is built
+    // from the declared access (rebuilt whenever the system list changes) and
+    // every system is dispatched to the thread pool as soon as all systems it
+    // conflicts with have finished. Main-thread systems run on the caller,
+    // which also helps drain the pool while it waits.
+    //
+    // Systems must not add or remove components directly while other systems
+    // may be iterating; they record those changes in getCommandBuffer() and
+    // the scheduler applies all buffers once every system has finished.
+    // Pools of the declared component types are created in addSystem, since
+    // lazy creation mid-run would resize the pool table under other readers.
+    class SystemScheduler
+    {
+    public:
+        using SystemFunction = std::function<void(float)>;
+
+        // Wraps every system call on whichever thread runs it, e.g. to make
+        // the owning world current there
+        using SystemScope = std::function<void(const std::function<void()>&)>;
+
+        struct SystemTiming
+        {
+            std::string name;
+            double milliseconds = 0.0;
+            ui32 threadSlot = 0;
+        };
+
+        // Command buffers are applied to componentManager; systems run
+        // inside scope when one is given
+        SystemScheduler(ThreadPool& threadPool, ComponentManager& componentManager, SystemScope scope = nullptr);
+
+        void addSystem(const std::string& name, const SystemAccess& access, SystemFunction function);
+        void run(float deltaTime);
+
+        // Command buffer owned by the calling thread, which must be one of
+        // this scheduler's pool workers or no pool's worker at all
+        CommandBuffer& getCommandBuffer();
+
+        // Applies every thread's command buffer in thread-slot order
+        void flushCommandBuffers();
+
+        // Timings of the last run, in registration order
+        const std::vector<SystemTiming>& getTimings() const { return m_timings; }
+        double getLastRunMilliseconds() const { return m_lastRunMilliseconds; }
+
+    private:
+        struct SystemEntry
+        {
+            std::string name;
+            SystemAccess access;
+            SystemFunction function;
+            std::vector<ui32> dependents;
+            ui32 dependencyCount = 0;
+        };
+
+        void buildGraph();
+
+    private:
+        ThreadPool& m_threadPool;
+        ComponentManager& m_componentManager;
+        SystemScope m_scope;
+        std::vector<CommandBuffer> m_commandBuffers;
+        std::vector<SystemEntry> m_systems;
+        std::vector<SystemTiming> m_timings;
+        double m_lastRunMilliseconds = 0.0;
+        bool m_graphDirty = true;
+    };
+}
@@ -0,0 +1,484 @@
+#include <../ECS/TransformHierarchy.h>
+#include <../Core/ThreadPool.h>
+#include <../Math/SIMD.h>
+#include <algorithm>
+#include <atomic>
+
+using namespace dx3d;
+
+namespace
+{
+    // Neighbours may already be gone if an entity was destroyed without
+    // removeFromHierarchy; stale handles simply fail to resolve here
+    void unlink(ComponentArray<HierarchyComponent>& hierarchies, EntityID entity)
+    {
+        HierarchyComponent* node = hierarchies.getComponent(entity);
+        if (node->parent == INVALID_ENTITY)
+            return;
+
+        HierarchyComponent* parentNode = hierarchies.getComponent(node->parent);
+        HierarchyComponent* prevNode = hierarchies.getComponent(node->prevSibling);
+        HierarchyComponent* nextNode = hierarchies.getComponent(node->nextSibling);
+
+        if (prevNode)
+        {
+            prevNode->nextSibling = node->nextSibling;
+        }
+        else if (parentNode && parentNode->firstChild == entity)
+        {
+            parentNode->firstChild = node->nextSibling;
+        }
+
+        if (nextNode)
+        {
+            nextNode->prevSibling = node->prevSibling;
+        }
+
+        if (parentNode && parentNode->childCount > 0)
+        {
+            parentNode->childCount--;
+        }
+        node->parent = INVALID_ENTITY;
+        node->prevSibling = INVALID_ENTITY;
+        node->nextSibling = INVALID_ENTITY;
+    }
+
+    // Re-derives depth for every descendant of root from root's depth
+    void updateSubtreeDepth(ComponentArray<HierarchyComponent>& hierarchies, EntityID root)
+    {
+        std::vector<EntityID> stack{ root };
+        while (!stack.empty())
+        {
+            EntityID entity = stack.back();
+            stack.pop_back();
+
+            const HierarchyComponent* node = hierarchies.getComponent(entity);
+            for (EntityID child = node->firstChild; child != INVALID_ENTITY;)
+            {
+                HierarchyComponent* childNode = hierarchies.getComponent(child);
+                if (!childNode)
+                    break;
+
+                childNode->depth = node->depth + 1;
+                stack.push_back(child);
+                child = childNode->nextSibling;
+            }
+        }
+    }
+}
+
+bool TransformHierarchy::setParent(ComponentManager& componentManager, EntityID child, EntityID parent)
+{
+    if (child == parent || !componentManager.isAlive(child))
+        return false;
+
+    if (parent != INVALID_ENTITY && (!componentManager.isAlive(parent) || isAncestor(componentManager, child, parent)))
+        return false;
+
+    auto& hierarchies = *componentManager.getComponentArray<HierarchyComponent>();
+    if (!hierarchies.hasComponent(child))
+    {
+        if (parent == INVALID_ENTITY)
+            return true;
+
+        hierarchies.addComponent(child, HierarchyComponent{});
+    }
+    if (parent != INVALID_ENTITY && !hierarchies.hasComponent(parent))
+    {
+        hierarchies.addComponent(parent, HierarchyComponent{});
+    }
+
+    // No more inserts below, so component pointers stay valid
+    HierarchyComponent* node = hierarchies.getComponent(child);
+    if (node->parent == parent)
+        return true;
+
+    unlink(hierarchies, child);
+
+    if (parent != INVALID_ENTITY)
+    {
+        HierarchyComponent* parentNode = hierarchies.getComponent(parent);
+        node->parent = parent;
+        node->nextSibling = parentNode->firstChild;
+        if (parentNode->firstChild != INVALID_ENTITY)
+        {
+            hierarchies.getComponent(parentNode->firstChild)->prevSibling = child;
+        }
+        parentNode->firstChild = child;
+        parentNode->childCount++;
+        node->depth = parentNode->depth + 1;
+    }
+    else
+    {
+        node->depth = 0;
+    }
+
+    updateSubtreeDepth(hierarchies, child);
+    hierarchies.markChanged(child);
+    return true;
+}
+
+void TransformHierarchy::removeFromHierarchy(ComponentManager& componentManager, EntityID entity)
+{
+    auto& hierarchies = *componentManager.getComponentArray<HierarchyComponent>();
+    if (!hierarchies.hasComponent(entity))
+        return;
+
+    unlink(hierarchies, entity);
+
+    HierarchyComponent* node = hierarchies.getComponent(entity);
+    EntityID child = node->firstChild;
+    while (child != INVALID_ENTITY)
+    {
+        HierarchyComponent* childNode = hierarchies.getComponent(child);
+        if (!childNode)
+            break;
+
+        EntityID next = childNode->nextSibling;
+
+        childNode->parent = INVALID_ENTITY;
+        childNode->prevSibling = INVALID_ENTITY;
+        childNode->nextSibling = INVALID_ENTITY;
+        childNode->depth = 0;
+        updateSubtreeDepth(hierarchies, child);
+
+        child = next;
+    }
+
+    node->firstChild = INVALID_ENTITY;
+    node->childCount = 0;
+    hierarchies.markChanged(entity);
+}
+
+EntityID TransformHierarchy::getParent(const ComponentManager& componentManager, EntityID entity)
+{
+    const auto* node = componentManager.getComponent<HierarchyComponent>(entity);
+    return node ? node->parent : INVALID_ENTITY;
+}
+
+ui32 TransformHierarchy::getChildCount(const ComponentManager& componentManager, EntityID entity)
+{
+    const auto* node = componentManager.getComponent<HierarchyComponent>(entity);
+    return node ? node->childCount : 0;
+}
+
+bool TransformHierarchy::isAncestor(const ComponentManager& componentManager, EntityID ancestor, EntityID entity)
+{
+    for (EntityID current = getParent(componentManager, entity); current != INVALID_ENTITY; current = getParent(componentManager, current))
+    {
+        if (current == ancestor)
+            return true;
+    }
+    return false;
+}
+
+Matrix4x4 TransformHierarchy::computeWorldMatrix(const ComponentManager& componentManager, EntityID entity) const
+{
+    if (!componentManager.hasComponent<TransformComponent>(entity))
+        return Matrix4x4();
+
+    Matrix4x4 world = getLocalMatrix(componentManager, entity);
+    for (EntityID parent = getParent(componentManager, entity); parent != INVALID_ENTITY; parent = getParent(componentManager, parent))
+    {
+        if (!componentManager.hasComponent<TransformComponent>(parent))
+            break;
+
+        world = world * getLocalMatrix(componentManager, parent);
+    }
+    return world;
+}
+
+Matrix4x4 TransformHierarchy::getLocalMatrix(const ComponentManager& componentManager, EntityID entity) const
+{
+    const auto* transforms = componentManager.getComponentArray<TransformComponent>();
+    const TransformComponent* transform = transforms ? transforms->getComponent(entity) : nullptr;
+    if (!transform)
+        return Matrix4x4();
+
+    ui32 slot = getSlot(entity);
+    if (slot != INVALID_COMPONENT_INDEX && m_localVersions[slot] == transforms->getChangeVersion(entity))
+        return m_localMatrices[slot];
+
+    return transform->getWorldMatrix();
+}
+
+ui32 TransformHierarchy::getSlot(EntityID entity) const
+{
+    ui32 index = getEntityIndex(entity);
+    if (index >= m_slotOfIndex.size())
+        return INVALID_COMPONENT_INDEX;
+
+    ui32 slot = m_slotOfIndex[index];
+    return (slot != INVALID_COMPONENT_INDEX && m_order[slot] == entity) ? slot : INVALID_COMPONENT_INDEX;
+}
+
+void TransformHierarchy::rebuildOrder(ComponentManager& componentManager)
+{
+    const auto* transforms = componentManager.getComponentArray<TransformComponent>();
+    const auto* hierarchies = componentManager.getComponentArray<HierarchyComponent>();
+
+    const std::vector<EntityID>& entities = transforms->getEntities();
+    const ui32 count = static_cast<ui32>(entities.size());
+
+    // Counting sort by depth keeps the rebuild O(n)
+    auto depthOf = [hierarchies](EntityID entity)
+        {
+            const HierarchyComponent* node = hierarchies->getComponent(entity);
+            return node ? node->depth : 0u;
+        };
+
+    std::vector<ui32> depthStarts;
+    for (EntityID entity : entities)
+    {
+        ui32 depth = depthOf(entity);
+        if (depth + 1 >= depthStarts.size())
+        {
+            depthStarts.resize(static_cast<size_t>(depth) + 2, 0);
+        }
+        depthStarts[depth + 1]++;
+    }
+    for (size_t i = 1; i < depthStarts.size(); ++i)
+    {
+        depthStarts[i] += depthStarts[i - 1];
+    }
+    m_levelStarts = depthStarts;
+
+    // Keep the previous order around so cached locals can follow their
+    // entity to its new slot
+    std::vector<EntityID> previousOrder;
+    std::vector<ui32> previousSlotOfIndex;
+    std::vector<ComponentVersion> previousVersions;
+    std::vector<Matrix4x4> previousLocals;
+    previousOrder.swap(m_order);
+    previousSlotOfIndex.swap(m_slotOfIndex);
+    previousVersions.swap(m_localVersions);
+    previousLocals.swap(m_localMatrices);
+
+    m_order.resize(count);
+    for (EntityID entity : entities)
+    {
+        m_order[depthStarts[depthOf(entity)]++] = entity;
+    }
+
+    ui32 maxIndex = 0;
+    for (EntityID entity : entities)
+    {
+        maxIndex = std::max(maxIndex, getEntityIndex(entity));
+    }
+    m_slotOfIndex.assign(count ? static_cast<size_t>(maxIndex) + 1 : 0, INVALID_COMPONENT_INDEX);
+    for (ui32 slot = 0; slot < count; ++slot)
+    {
+        m_slotOfIndex[getEntityIndex(m_order[slot])] = slot;
+    }
+
+    m_transformSlots.resize(count);
+    m_parentSlots.resize(count);
+    m_localVersions.assign(count, 0);
+    m_localMatrices.resize(count);
+    m_worldMatrices.resize(count);
+    for (ui32 slot = 0; slot < count; ++slot)
+    {
+        EntityID entity = m_order[slot];
+        m_transformSlots[slot] = transforms->getIndex(entity);
+
+        // A parent without a transform of its own is treated as the origin
+        const HierarchyComponent* node = hierarchies->getComponent(entity);
+        ui32 parentSlot = INVALID_COMPONENT_INDEX;
+        if (node && node->parent != INVALID_ENTITY)
+        {
+            parentSlot = getSlot(node->parent);
+        }
+        m_parentSlots[slot] = parentSlot;
+
+        ui32 index = getEntityIndex(entity);
+        if (index < previousSlotOfIndex.size())
+        {
+            ui32 previousSlot = previousSlotOfIndex[index];
+            if (previousSlot != INVALID_COMPONENT_INDEX && previousOrder[previousSlot] == entity)
+            {
+                m_localVersions[slot] = previousVersions[previousSlot];
+                m_localMatrices[slot] = previousLocals[previousSlot];
+            }
+        }
+    }
+
+    m_orderHierarchyVersion = hierarchies->getVersion();
+    m_orderTransformStructure = transforms->getStructureVersion();
+    m_orderValid = true;
+}
+
+void TransformHierarchy::updateRange(const ComponentArray<TransformComponent>& transforms, ui32 begin, ui32 end,
+    ui32& localRebuilds, ui32& worldRebuilds)
+{
+    constexpr ui32 BLOCK_SIZE = 64;
+
+    const TransformComponent* transformData = transforms.data();
+    const ComponentVersion* versions = transforms.changeVersions();
+
+    // Dirty locals are gathered into SoA blocks for the wide compose kernel
+    alignas(16) float components[10][BLOCK_SIZE];
+    ui32 blockSlots[BLOCK_SIZE];
+    Matrix4x4 composed[BLOCK_SIZE];
+    ui32 blockSize = 0;
+
+    const simd::TransformArrays arrays = {
+        { components[0], components[1], components[2] },
+        { components[3], components[4], components[5], components[6] },
+        { components[7], components[8], components[9] } };
+
+    auto flush = [&]()
+        {
+            // When every slot in the block is dirty (the all-moving case) the
+            // slots are consecutive and the kernel can write in place
+            if (blockSlots[blockSize - 1] - blockSlots[0] == blockSize - 1)
+            {
+                simd::composeTransforms(arrays, &m_localMatrices[blockSlots[0]], blockSize);
+            }
+            else
+            {
+                simd::composeTransforms(arrays, composed, blockSize);
+                for (ui32 i = 0; i < blockSize; ++i)
+                {
+                    m_localMatrices[blockSlots[i]] = composed[i];
+                }
+            }
+            localRebuilds += blockSize;
+            blockSize = 0;
+        };
+
+    for (ui32 slot = begin; slot < end; ++slot)
+    {
+        const ui32 transformSlot = m_transformSlots[slot];
+        if (m_localVersions[slot] == versions[transformSlot])
+            continue;
+
+        const TransformComponent& transform = transformData[transformSlot];
+        components[0][blockSize] = transform.position.x;
+        components[1][blockSize] = transform.position.y;
+        components[2][blockSize] = transform.position.z;
+        components[3][blockSize] = transform.rotation.x;
+        components[4][blockSize] = transform.rotation.y;
+        components[5][blockSize] = transform.rotation.z;
+        components[6][blockSize] = transform.rotation.w;
+        components[7][blockSize] = transform.scale.x;
+        components[8][blockSize] = transform.scale.y;
+        components[9][blockSize] = transform.scale.z;
+        blockSlots[blockSize++] = slot;
+
+        m_localVersions[slot] = versions[transformSlot];
+        m_worldDirty[slot] = 1;
+
+        if (blockSize == BLOCK_SIZE)
+        {
+            flush();
+        }
+    }
+    if (blockSize > 0)
+    {
+        flush();
+    }
+
+    // Parents live in earlier levels, so their dirty flags and world
+    // matrices are final here
+    for (ui32 slot = begin; slot < end; ++slot)
+    {
+        const ui32 parentSlot = m_parentSlots[slot];
+        const bool parentDirty = parentSlot != INVALID_COMPONENT_INDEX && m_worldDirty[parentSlot];
+        if (!m_worldDirty[slot] && !parentDirty)
+            continue;
+
+        if (parentSlot == INVALID_COMPONENT_INDEX)
+        {
+            m_worldMatrices[slot] = m_localMatrices[slot];
+        }
+        else
+        {
+            simd::storeMatrix(&m_worldMatrices[slot].m[0][0], simd::multiply(
+                simd::loadMatrix(&m_localMatrices[slot].m[0][0]),
+                simd::loadMatrix(&m_worldMatrices[parentSlot].m[0][0])));
+        }
+        m_worldDirty[slot] = 1;
+        worldRebuilds++;
+    }
+}
+
+void TransformHierarchy::update(ComponentManager& componentManager, ThreadPool* threadPool)
+{
+    // Slots per parallel chunk; below this the dispatch costs more than it saves
+    constexpr ui32 GRAIN_SIZE = 2048;
+
+    const auto* transforms = componentManager.getComponentArray<TransformComponent>();
+    const auto* hierarchies = componentManager.getComponentArray<HierarchyComponent>();
+
+    m_lastLocalRebuilds = 0;
+    m_lastWorldRebuilds = 0;
+
+    bool rebuilt = false;
+    if (!m_orderValid ||
+        m_orderHierarchyVersion != hierarchies->getVersion() ||
+        m_orderTransformStructure != transforms->getStructureVersion())
+    {
+        rebuildOrder(componentManager);
+        rebuilt = true;
+    }
+
+    // Nothing was written since the last pass: every cached matrix is valid
+    if (!rebuilt && m_updated && transforms->getVersion() == m_updatedTransformVersion)
+        return;
+
+    // After a rebuild links may have changed, so every world matrix is
+    // recombined (locals are still reused where their version matches)
+    m_worldDirty.assign(m_order.size(), rebuilt ? 1 : 0);
+
+    std::atomic<ui32> localRebuilds{ 0 };
+    std::atomic<ui32> worldRebuilds{ 0 };
+    auto runRange = [&](ui32 begin, ui32 end)
+        {
+            ui32 locals = 0, worlds = 0;
+            updateRange(*transforms, begin, end, locals, worlds);
+            localRebuilds.fetch_add(locals, std::memory_order_relaxed);
+            worldRebuilds.fetch_add(worlds, std::memory_order_relaxed);
+        };
+
+    for (size_t level = 0; level + 1 < m_levelStarts.size(); ++level)
+    {
+        const ui32 levelBegin = m_levelStarts[level];
+        const ui32 levelEnd = m_levelStarts[level + 1];
+
+        if (threadPool && levelEnd - levelBegin > GRAIN_SIZE)
+        {
+            threadPool->parallelFor(levelEnd - levelBegin, GRAIN_SIZE, [&](ui32 begin, ui32 end)
+                {
+                    runRange(levelBegin + begin, levelBegin + end);
+                });
+        }
+        else
+        {
+            runRange(levelBegin, levelEnd);
+        }
+    }
+
+    m_lastLocalRebuilds = localRebuilds.load();
+    m_lastWorldRebuilds = worldRebuilds.load();
+    m_updatedTransformVersion = transforms->getVersion();
+    m_updatedHierarchyVersion = hierarchies->getVersion();
+    m_updated = true;
+}
+
+bool TransformHierarchy::isUpToDate(const ComponentManager& componentManager) const
+{
+    return m_updated &&
+        componentManager.getVersion<TransformComponent>() == m_updatedTransformVersion &&
+        componentManager.getVersion<HierarchyComponent>() == m_updatedHierarchyVersion;
+}
+
+Matrix4x4 TransformHierarchy::getWorldMatrix(const ComponentManager& componentManager, EntityID entity) const
+{
+    if (isUpToDate(componentManager))
+    {
+        ui32 slot = getSlot(entity);
+        if (slot != INVALID_COMPONENT_INDEX)
+            return m_worldMatrices[slot];
+    }
+    return computeWorldMatrix(componentManager, entity);
+}
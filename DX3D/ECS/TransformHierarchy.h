@@ -0,0 +1,129 @@
+#pragma once
+#include "../ECS/ComponentManager.h"
+#include "../ECS/Components/TransformComponent.h"
+#include "../ECS/Components/HierarchyComponent.h"
+#include <vector>
+
+namespace dx3d
+{
+    class ThreadPool;
+
+    // Flat transform hierarchy over HierarchyComponent links.
+    //
+    // The static helpers edit the links. update() is the per-frame world pass:
+    // it walks every TransformComponent in depth order, so parents are always
+    // resolved before their children, and writes local and world matrices
+    // into contiguous arrays indexed by slot (position in that order). The
+    // order is cached and only rebuilt when the hierarchy or the set of
+    // transforms changes; cached locals survive a rebuild.
+    //
+    // Dirtiness comes from the transform pool's change versions: an entity
+    // rebuilds its local matrix only if its transform was written since the
+    // cached one, and its world matrix only if that local or its parent's
+    // world changed. The flag propagates down in the same pass, and a frame
+    // with no transform writes returns before touching any entity.
+    //
+    // Entities at one depth are independent, so each depth level is split
+    // into chunks across the thread pool. Within a chunk dirty transforms are
+    // gathered into structure-of-arrays blocks and composed four at a time
+    // by simd::composeTransforms.
+    class TransformHierarchy
+    {
+    public:
+        // Makes parent the parent of child, or detaches child when parent is
+        // INVALID_ENTITY. Returns false if that would create a cycle.
+        static bool setParent(ComponentManager& componentManager, EntityID child, EntityID parent);
+        static void detach(ComponentManager& componentManager, EntityID child) { setParent(componentManager, child, INVALID_ENTITY); }
+
+        // Detaches the entity from its parent and turns its children into
+        // roots. Call before destroying an entity that may have links.
+        static void removeFromHierarchy(ComponentManager& componentManager, EntityID entity);
+
+        static EntityID getParent(const ComponentManager& componentManager, EntityID entity);
+        static ui32 getChildCount(const ComponentManager& componentManager, EntityID entity);
+        static bool isAncestor(const ComponentManager& componentManager, EntityID ancestor, EntityID entity);
+
+        template<typename Func>
+        static void forEachChild(const ComponentManager& componentManager, EntityID entity, Func&& func)
+        {
+            const auto* node = componentManager.getComponent<HierarchyComponent>(entity);
+            EntityID child = node ? node->firstChild : INVALID_ENTITY;
+            while (child != INVALID_ENTITY)
+            {
+                const auto* childNode = componentManager.getComponent<HierarchyComponent>(child);
+                if (!childNode)
+                    break;
+
+                func(child);
+                child = childNode->nextSibling;
+            }
+        }
+
+        // Walks the parent chain; O(depth). Used for queries made between a
+        // transform edit and the next world pass. Reuses cached local
+        // matrices that are still valid.
+        Matrix4x4 computeWorldMatrix(const ComponentManager& componentManager, EntityID entity) const;
+
+        // Cached local matrix if the transform is unchanged, else rebuilt
+        Matrix4x4 getLocalMatrix(const ComponentManager& componentManager, EntityID entity) const;
+
+        // Brings every dirty world matrix up to date. With a pool, each depth
+        // level is processed in parallel chunks.
+        void update(ComponentManager& componentManager, ThreadPool* threadPool = nullptr);
+
+        // True if no transform or link changed since the last update()
+        bool isUpToDate(const ComponentManager& componentManager) const;
+
+        // World matrix from the last pass if still valid, otherwise computed
+        // from the parent chain
+        Matrix4x4 getWorldMatrix(const ComponentManager& componentManager, EntityID entity) const;
+
+        // World matrices from the last update(), one per slot. Parents always
+        // precede their children. Valid while isUpToDate() holds.
+        const std::vector<Matrix4x4>& getWorldMatrices() const { return m_worldMatrices; }
+        // Entity owning each slot
+        const std::vector<EntityID>& getSlotEntities() const { return m_order; }
+        // INVALID_COMPONENT_INDEX if the entity has no transform or the order
+        // has not been rebuilt since it got one
+        ui32 getSlot(EntityID entity) const;
+
+        // Matrices rebuilt by the last update(), for profiling
+        ui32 getLastLocalRebuildCount() const { return m_lastLocalRebuilds; }
+        ui32 getLastWorldRebuildCount() const { return m_lastWorldRebuilds; }
+
+    private:
+        void rebuildOrder(ComponentManager& componentManager);
+        // Updates slots [begin, end) of one depth level and adds the number
+        // of matrices it rebuilt to the counters
+        void updateRange(const ComponentArray<TransformComponent>& transforms, ui32 begin, ui32 end,
+            ui32& localRebuilds, ui32& worldRebuilds);
+
+    private:
+        // Depth-sorted traversal order and, per slot, the dense index into
+        // the transform pool plus the slot of the parent
+        std::vector<EntityID> m_order;
+        std::vector<ui32> m_transformSlots;
+        std::vector<ui32> m_parentSlots;
+        // First slot of each depth level, plus a final end marker
+        std::vector<ui32> m_levelStarts;
+        // Map from entity index to slot
+        std::vector<ui32> m_slotOfIndex;
+
+        // Per slot: transform version the local matrix was built from (0 if
+        // never), the cached matrices, and whether the world matrix was
+        // rebuilt in the current pass
+        std::vector<ComponentVersion> m_localVersions;
+        std::vector<Matrix4x4> m_localMatrices;
+        std::vector<Matrix4x4> m_worldMatrices;
+        std::vector<char> m_worldDirty;
+
+        ComponentVersion m_orderHierarchyVersion = 0;
+        ComponentVersion m_orderTransformStructure = 0;
+        ComponentVersion m_updatedTransformVersion = 0;
+        ComponentVersion m_updatedHierarchyVersion = 0;
+        ui32 m_lastLocalRebuilds = 0;
+        ui32 m_lastWorldRebuilds = 0;
+        bool m_orderValid = false;
+        bool m_updated = false;
+    };
+}
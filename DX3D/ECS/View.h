@@ -0,0 +1,150 @@
+#pragma once
+#include "../ECS/Entity.h"
+#include "../ECS/ComponentArray.h"
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace dx3d
+{
+    // Tag used to pass exclusion filters to ComponentManager::view, e.g.
+    // view<TransformComponent>(Exclude<PhysicsComponent>{})
+    template<typename... Excluded>
+    struct Exclude {};
+
+    // Iterates every entity that owns all of Components... and none of the
+    // excluded component types. Iteration is driven by the smallest pool and
+    // the remaining pools are probed through their sparse index, so no hash
+    // lookups happen per entity. Pools must not be structurally modified
+    // (add/remove) while a view is being iterated.
+    template<typename... Components>
+    class View
+    {
+        static_assert(sizeof...(Components) > 0, "View requires at least one component type");
+
+    public:
+        View(ComponentArray<Components>*... pools, std::vector<const IComponentArray*> excluded) :
+            m_pools(pools...),
+            m_excluded(std::move(excluded))
+        {
+            m_valid = ((pools != nullptr) && ...);
+            if (m_valid)
+            {
+                m_driver = &std::get<0>(m_pools)->getEntities();
+                ((m_driver = pools->getEntities().size() < m_driver->size() ? &pools->getEntities() : m_driver), ...);
+            }
+        }
+
+        // Upper bound on the number of entities the view will visit
+        size_t sizeHint() const { return m_valid ? m_driver->size() : 0; }
+
+        bool contains(EntityID entity) const
+        {
+            if (!m_valid)
+                return false;
+
+            if (!((std::get<ComponentArray<Components>*>(m_pools)->getIndex(entity) != ComponentArray<Components>::INVALID_INDEX) && ...))
+                return false;
+
+            return !isExcluded(entity);
+        }
+
+        template<typename T>
+        T& get(EntityID entity) const
+        {
+            return *std::get<ComponentArray<T>*>(m_pools)->getComponent(entity);
+        }
+
+        // func is called as func(EntityID, Components&...) or func(Components&...)
+        template<typename Func>
+        void each(Func&& func) const
+        {
+            if (!m_valid)
+                return;
+
+            const std::vector<EntityID>& entities = *m_driver;
+            for (size_t i = 0; i < entities.size(); ++i)
+            {
+                EntityID entity = entities[i];
+
+                std::array<ui32, sizeof...(Components)> indices{ std::get<ComponentArray<Components>*>(m_pools)->getIndex(entity)... };
+                if (!allValid(indices) || isExcluded(entity))
+                    continue;
+
+                invoke(func, entity, indices, std::index_sequence_for<Components...>{});
+            }
+        }
+
+        // Like each(), but only visits entities whose Tracked component was
+        // written after version (see ComponentArray::markChanged). Iteration
+        // is driven by the Tracked pool and returns early if nothing in it
+        // changed, so static scenes cost a single comparison.
+        template<typename Tracked, typename Func>
+        void eachChangedSince(ComponentVersion version, Func&& func) const
+        {
+            if (!m_valid)
+                return;
+
+            const ComponentArray<Tracked>* tracked = std::get<ComponentArray<Tracked>*>(m_pools);
+            if (tracked->getVersion() <= version)
+                return;
+
+            const std::vector<EntityID>& entities = tracked->getEntities();
+            const ComponentVersion* versions = tracked->changeVersions();
+            for (size_t i = 0; i < entities.size(); ++i)
+            {
+                if (versions[i] <= version)
+                    continue;
+
+                EntityID entity = entities[i];
+
+                std::array<ui32, sizeof...(Components)> indices{ std::get<ComponentArray<Components>*>(m_pools)->getIndex(entity)... };
+                if (!allValid(indices) || isExcluded(entity))
+                    continue;
+
+                invoke(func, entity, indices, std::index_sequence_for<Components...>{});
+            }
+        }
+
+    private:
+        static bool allValid(const std::array<ui32, sizeof...(Components)>& indices)
+        {
+            for (ui32 index : indices)
+            {
+                if (index == INVALID_COMPONENT_INDEX)
+                    return false;
+            }
+            return true;
+        }
+
+        bool isExcluded(EntityID entity) const
+        {
+            for (const IComponentArray* excluded : m_excluded)
+            {
+                if (excluded && excluded->containsEntity(entity))
+                    return true;
+            }
+            return false;
+        }
+
+        template<typename Func, size_t... I>
+        void invoke(Func& func, EntityID entity, const std::array<ui32, sizeof...(Components)>& indices, std::index_sequence<I...>) const
+        {
+            if constexpr (std::is_invocable_v<Func&, EntityID, Components&...>)
+            {
+                func(entity, std::get<I>(m_pools)->data()[indices[I]]...);
+            }
+            else
+            {
+                func(std::get<I>(m_pools)->data()[indices[I]]...);
+            }
+        }
+
+    private:
+        std::tuple<ComponentArray<Components>*...> m_pools;
+        std::vector<const IComponentArray*> m_excluded;
+        const std::vector<EntityID>* m_driver = nullptr;
+        bool m_valid = false;
+    };
+}
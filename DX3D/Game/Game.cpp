@@ -40,8 +40,13 @@
 
 #include <../ECS/ComponentManager.h>
 #include <../ECS/Components/TransformComponent.h>
+#include <../ECS/Components/HierarchyComponent.h>
 #include <../ECS/Components/PhysicsComponent.h>
+#include <../ECS/Components/TerrainComponent.h>
 #include <../Physics/PhysicsSystem.h>
+#include <../Scene/World.h>
+#include <../ECS/SystemScheduler.h>
+#include <../Core/ThreadPool.h>
 
 #include <../UI/UIManager.h>
 #include <../JSON/json.hpp>
@@ -57,6 +62,7 @@
 #include <random>
 #include <string>
 #include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <DirectXMath.h>
 
@@ -65,7 +71,8 @@ namespace fs = std::filesystem;
 
 dx3d::Game::Game(const GameDesc& desc) :
     Core({ *std::make_unique<Logger>(desc.logLevel).release() }),
-    m_loggerPtr(&m_loggerInstance)
+    m_loggerPtr(&m_loggerInstance),
+    m_world(World::getDefault())
 {
     m_graphicsEngine = std::make_unique<GraphicsEngine>(GraphicsEngineDesc{ m_loggerInstance });
     m_display = std::make_unique<Display>(DisplayDesc{ {m_loggerInstance,desc.windowSize},m_graphicsEngine->getRenderSystem() });
@@ -97,6 +104,16 @@ dx3d::Game::Game(const GameDesc& desc) :
     };
     m_uiManager = std::make_unique<UIManager>(uiDeps);
 
+    m_threadPool = std::make_unique<ThreadPool>();
+    // Workers may be shared between worlds, so each system makes ours current
+    m_systemScheduler = std::make_unique<SystemScheduler>(*m_threadPool, m_world.getComponentManager(),
+        [this](const std::function<void()>& system)
+        {
+            World::Scope scope(m_world);
+            system();
+        });
+    registerSystems();
+
     spawnDirectionalLight();
 
     DX3DLogInfo("Game initialized with ECS, Physics, and Scene State systems.");
@@ -119,7 +136,7 @@ dx3d::Game::~Game()
     }
     m_gameObjects.clear();
 
-    PhysicsSystem::getInstance().shutdown();
+    m_world.getPhysicsSystem().shutdown();
 
     if (m_particleDepthState) m_particleDepthState->Release();
     if (m_solidDepthState) m_solidDepthState->Release();
@@ -134,12 +151,15 @@ void dx3d::Game::createRenderingResources()
     ID3D11Device* device = nullptr;
     d3dContext->GetDevice(&device);
 
-    auto& componentManager = ComponentManager::getInstance();
+    auto& componentManager = m_world.getComponentManager();
     componentManager.registerComponent<TransformComponent>();
+    componentManager.registerComponent<HierarchyComponent>();
+    componentManager.registerComponent<GameObjectComponent>();
     componentManager.registerComponent<PhysicsComponent>();
+    componentManager.registerComponent<TerrainComponent>();
     componentManager.registerComponent<MaterialComponent>();
 
-    PhysicsSystem::getInstance().initialize();
+    m_world.getPhysicsSystem().initialize();
     ResourceManager::getInstance().initialize(resourceDesc);
 
     DX3DLogInfo("ECS and Physics systems initialized successfully.");
@@ -419,36 +439,82 @@ void dx3d::Game::update()
     ImGui_ImplWin32_NewFrame();
     ImGui::NewFrame();
 
-    m_sceneStateManager->update(m_deltaTime);
+    m_systemScheduler->run(m_deltaTime);
 
-    processInput(m_deltaTime);
+    static float debugTimer = 0.0f;
+    debugTimer += m_deltaTime;
+    if (debugTimer >= 5.0f)
+    {
+        DX3DLogInfo(("Physics demo running - " + std::to_string(m_gameObjects.size()) + " objects").c_str());
 
-    m_sceneCamera->update();
+        std::ostringstream timings;
+        timings << std::fixed << std::setprecision(3) << "System timings (ms):";
+        for (const auto& timing : m_systemScheduler->getTimings())
+        {
+            timings << " " << timing.name << "=" << timing.milliseconds;
+        }
+        timings << " | total=" << m_systemScheduler->getLastRunMilliseconds();
+        DX3DLogInfo(timings.str().c_str());
 
-    if (m_sceneStateManager->isPlayMode())
-    {
-        m_fpsController->update(m_deltaTime);
+        debugTimer = 0.0f;
     }
+}
 
+void dx3d::Game::registerSystems()
+{
+    // Registration order is execution order for systems whose access
+    // conflicts; the rest may overlap on the worker threads.
+    m_systemScheduler->addSystem("SceneState",
+        SystemAccess().exclusive().mainThread(),
+        [this](float deltaTime) { m_sceneStateManager->update(deltaTime); });
+
+    m_systemScheduler->addSystem("Input",
+        SystemAccess().exclusive().mainThread(),
+        [this](float deltaTime) { processInput(deltaTime); });
+
+    m_systemScheduler->addSystem("SceneCamera",
+        SystemAccess().writesResource<SceneCamera>(),
+        [this](float) { m_sceneCamera->update(); });
+
+    m_systemScheduler->addSystem("FPSController",
+        SystemAccess().writesResource<SceneCamera>().readsResource<SceneStateManager>().mainThread(),
+        [this](float deltaTime)
+        {
+            if (m_sceneStateManager->isPlayMode())
+            {
+                m_fpsController->update(deltaTime);
+            }
+        });
 
-    if(m_deltaTime > 0.0f)
-        updatePhysics(m_deltaTime);
+    m_systemScheduler->addSystem("Physics",
+        SystemAccess().writes<TransformComponent, PhysicsComponent>().writesResource<PhysicsSystem, SceneStateManager>(),
+        [this](float deltaTime)
+        {
+            if (deltaTime > 0.0f)
+                updatePhysics(deltaTime);
+        });
 
-    for (auto& gameObject : m_gameObjects)
-    {
-        if (gameObject->isEnabled())
+    m_systemScheduler->addSystem("GameObjects",
+        SystemAccess().writes<TransformComponent, PhysicsComponent, MaterialComponent>().mainThread(),
+        [this](float deltaTime)
         {
-            gameObject->update(m_deltaTime);
-        }
-    }
+            for (auto& gameObject : m_gameObjects)
+            {
+                if (gameObject->isEnabled())
+                {
+                    gameObject->update(deltaTime);
+                }
+            }
+        });
 
-    static float debugTimer = 0.0f;
-    debugTimer += m_deltaTime;
-    if (debugTimer >= 5.0f)
-    {
-        DX3DLogInfo(("Physics demo running - " + std::to_string(m_gameObjects.size()) + " objects").c_str());
-        debugTimer = 0.0f;
-    }
+    // Runs after everything that writes transforms so rendering sees this
+    // frame's world matrices
+    m_systemScheduler->addSystem("TransformHierarchy",
+        SystemAccess().reads<TransformComponent, HierarchyComponent>().writesResource<TransformHierarchy>(),
+        [this](float)
+        {
+            m_world.getTransformHierarchy().update(m_world.getComponentManager(), m_threadPool.get());
+        });
 }
 
 void dx3d::Game::loadScene(const std::string& filename)
@@ -575,6 +641,12 @@ void dx3d::Game::loadScene(const std::string& filename)
                 newObject->setPhysicsFriction(goJson["physics"].value("friction", 0.5f));
             }
 
+            if (goJson.value("terrain", false)) {
+                if (auto model = std::dynamic_pointer_cast<Model>(newObject)) {
+                    attachTerrain(model);
+                }
+            }
+
             // Load light properties
             if (auto light = std::dynamic_pointer_cast<LightObject>(newObject))
             {
@@ -717,7 +789,7 @@ void dx3d::Game::saveScene()
                 // Save physics
                 if (go->hasPhysics())
                 {
-                    auto* physicsComp = dx3d::ComponentManager::getInstance().getComponent<PhysicsComponent>(go->getEntity().getID());
+                    auto* physicsComp = m_world.getComponentManager().getComponent<PhysicsComponent>(go->getEntity().getID());
                     if (physicsComp)
                     {
                         // Helper to convert enum to string
@@ -745,6 +817,7 @@ void dx3d::Game::saveScene()
                         {"enabled", false}
                     };
                 }
+                goJson["terrain"] = go->hasTerrain();
 
                 /*if (go->hasMaterial()) {
                     auto* materialComp = dx3d::ComponentManager::getInstance().getComponent<MaterialComponent>(go->getEntity().getID());
@@ -833,7 +906,7 @@ void dx3d::Game::updatePhysics(float deltaTime)
         // Handle frame step in pause mode
         if (m_sceneStateManager->isPauseMode() && m_sceneStateManager->isFrameStepRequested())
         {
-            PhysicsSystem::getInstance().update(1.0f / 60.0f);
+            m_world.getPhysicsSystem().step();
             // Clear the frame step request after physics update
             m_sceneStateManager->clearFrameStepRequest();
         }
@@ -842,7 +915,7 @@ void dx3d::Game::updatePhysics(float deltaTime)
 
     if (m_sceneStateManager->isPlayMode())
     {
-        PhysicsSystem::getInstance().update(deltaTime);
+        m_world.getPhysicsSystem().update(deltaTime);
     }
 }
 
@@ -866,8 +939,8 @@ void dx3d::Game::renderScene(SceneCamera& camera, RenderTexture* renderTarget)
     {
         lcb.lights[i] = m_lights[i]->getLightData();
     }
-    lcb.light_view = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(m_lightViewMatrix.toXMMatrix()));
-    lcb.light_projection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(m_lightProjectionMatrix.toXMMatrix()));
+    lcb.light_view = Matrix4x4::Transpose(m_lightViewMatrix);
+    lcb.light_projection = Matrix4x4::Transpose(m_lightProjectionMatrix);
 
     m_lightConstantBuffer->update(deviceContext, &lcb);
 
@@ -1038,9 +1111,9 @@ void dx3d::Game::renderScene(SceneCamera& camera, RenderTexture* renderTarget)
 
                     // Set transformation matrix
                     TransformationMatrices transformMatrices;
-                    transformMatrices.world = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(gameObject->getWorldMatrix().toXMMatrix()));
-                    transformMatrices.view = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(camera.getViewMatrix().toXMMatrix()));
-                    transformMatrices.projection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(projMatrix.toXMMatrix()));
+                    transformMatrices.world = Matrix4x4::Transpose(gameObject->getWorldMatrix());
+                    transformMatrices.view = Matrix4x4::Transpose(camera.getViewMatrix());
+                    transformMatrices.projection = Matrix4x4::Transpose(projMatrix);
                     m_transformConstantBuffer->update(deviceContext, &transformMatrices);
 
                     // Draw this mesh
@@ -1065,9 +1138,9 @@ void dx3d::Game::renderScene(SceneCamera& camera, RenderTexture* renderTarget)
             d3dContext->PSSetConstantBuffers(1, 1, &materialCb);
 
             TransformationMatrices transformMatrices;
-            transformMatrices.world = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(gameObject->getWorldMatrix().toXMMatrix()));
-            transformMatrices.view = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(camera.getViewMatrix().toXMMatrix()));
-            transformMatrices.projection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(projMatrix.toXMMatrix())); // Use the new projMatrix
+            transformMatrices.world = Matrix4x4::Transpose(gameObject->getWorldMatrix());
+            transformMatrices.view = Matrix4x4::Transpose(camera.getViewMatrix());
+            transformMatrices.projection = Matrix4x4::Transpose(projMatrix); // Use the new projMatrix
             m_transformConstantBuffer->update(deviceContext, &transformMatrices);
 
             deviceContext.drawIndexed(indexCount, 0, 0);
@@ -1110,11 +1183,24 @@ void dx3d::Game::renderShadowMapPass()
     {
         m_lightViewMatrix = Matrix4x4();
         m_lightProjectionMatrix = Matrix4x4();
+        m_shadowMapValid = false;
         return;
     }
 
     shadowCastingLight = &shadowCastingObject->getLightData();
 
+    // The depth map only depends on the casting light and on object
+    // transforms. If neither changed since the last pass, keep last frame's map.
+    ComponentVersion transformVersion = m_world.getComponentManager().getVersion<TransformComponent>();
+    if (m_shadowMapValid &&
+        m_shadowTransformVersion == transformVersion &&
+        m_shadowObjectCount == m_gameObjects.size() &&
+        m_shadowLight == shadowCastingObject.get() &&
+        std::memcmp(&m_shadowLightData, shadowCastingLight, sizeof(Light)) == 0)
+    {
+        return;
+    }
+
     m_shadowMap->clear(deviceContext);
     m_shadowMap->setAsRenderTarget(deviceContext);
 
@@ -1129,31 +1215,16 @@ void dx3d::Game::renderShadowMapPass()
         Vector3 lightPos = Vector3(0, 0, 0) - (shadowCastingLight->direction * 50.0f);
         Vector3 target = Vector3(0, 0, 0);
         lightView = Matrix4x4::CreateLookAtLH(lightPos, target, Vector3(0, 1, 0));
-        lightProjection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixOrthographicLH(40.0f, 40.0f, 1.0f, 100.0f));
+        lightProjection = Matrix4x4::CreateOrthographicLH(40.0f, 40.0f, 1.0f, 100.0f);
     }
     else if (shadowCastingLight->type == LIGHT_TYPE_SPOT)
     {
         // Get the world matrix of the light source itself
         Matrix4x4 world = shadowCastingObject->getWorldMatrix();
-        DirectX::XMMATRIX xmWorld = world.toXMMatrix(); // Convert to DirectX matrix
-
-        // --- Calculate World-Space Direction ---
-        // Define local forward vector (Z-axis) for DirectX
-        DirectX::XMVECTOR localForward = DirectX::XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
-        // Transform and normalize using DirectXMath functions
-        DirectX::XMVECTOR worldForward = DirectX::XMVector3TransformNormal(localForward, xmWorld);
-        worldForward = DirectX::XMVector3Normalize(worldForward);
-        // Convert back to your Vector3 class (assuming a constructor exists)
-        Vector3 lightDir = Vector3(worldForward);
-
-        // --- Calculate World-Space Up Vector ---
-        // Define local up vector (Y-axis) for DirectX
-        DirectX::XMVECTOR localUp = DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-        // Transform and normalize using DirectXMath functions
-        DirectX::XMVECTOR worldUp = DirectX::XMVector3TransformNormal(localUp, xmWorld);
-        worldUp = DirectX::XMVector3Normalize(worldUp);
-        // Convert back to your Vector3 class
-        Vector3 up = Vector3(worldUp);
+
+        // Local forward (Z) and up (Y) axes in world space
+        Vector3 lightDir = Vector3::Normalize(Matrix4x4::TransformNormal(Vector3(0.0f, 0.0f, 1.0f), world));
+        Vector3 up = Vector3::Normalize(Matrix4x4::TransformNormal(Vector3(0.0f, 1.0f, 0.0f), world));
 
         // Position and Target are calculated as before
         Vector3 lightPos(world.m[3][0], world.m[3][1], world.m[3][2]);
@@ -1162,7 +1233,7 @@ void dx3d::Game::renderShadowMapPass()
         lightView = Matrix4x4::CreateLookAtLH(lightPos, target, up);
 
         float fov_degrees = shadowCastingLight->spot_angle_outer * 2.0f;
-        float fov_radians = DirectX::XMConvertToRadians(fov_degrees);
+        float fov_radians = fov_degrees * (3.14159265f / 180.0f);
 
         lightProjection = Matrix4x4::CreatePerspectiveFovLH(
             fov_radians, // Use the corrected value in radians
@@ -1189,6 +1260,12 @@ void dx3d::Game::renderShadowMapPass()
     m_lightViewMatrix = lightView;
     m_lightProjectionMatrix = lightProjection;
 
+    m_shadowMapValid = true;
+    m_shadowTransformVersion = transformVersion;
+    m_shadowObjectCount = m_gameObjects.size();
+    m_shadowLight = shadowCastingObject.get();
+    m_shadowLightData = *shadowCastingLight;
+
     // Render all shadow-casting objects
     for (const auto& gameObject : m_gameObjects)
     {
@@ -1197,9 +1274,9 @@ void dx3d::Game::renderShadowMapPass()
         }
 
         LightTransformMatrices ltm;
-        ltm.world = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(gameObject->getWorldMatrix().toXMMatrix()));
-        ltm.light_view = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(lightView.toXMMatrix()));
-        ltm.light_projection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(lightProjection.toXMMatrix()));
+        ltm.world = Matrix4x4::Transpose(gameObject->getWorldMatrix());
+        ltm.light_view = Matrix4x4::Transpose(lightView);
+        ltm.light_projection = Matrix4x4::Transpose(lightProjection);
         m_lightTransformConstantBuffer->update(deviceContext, &ltm);
 
         ID3D11Buffer* lightTransformCb = m_lightTransformConstantBuffer->getBuffer();
@@ -1421,7 +1498,10 @@ void dx3d::Game::spawnModel(const std::string& filename)
 
         if (model && model->isReadyForRendering())
         {
-            Vector3 position(0.0f, 5.0f, 0.0f);
+            // Ground rather than a falling object
+            bool isTerrain = filename == "terrain.obj";
+
+            Vector3 position = isTerrain ? Vector3(0.0f, 0.0f, 0.0f) : Vector3(0.0f, 5.0f, 0.0f);
             Vector3 scale(1.0f, 1.0f, 1.0f);
 
             if (filename == "lucy.obj") {
@@ -1433,10 +1513,17 @@ void dx3d::Game::spawnModel(const std::string& filename)
 
             model->setPosition(position);
             model->setScale(scale);
-            model->enablePhysics(PhysicsBodyType::Dynamic);
-            model->setPhysicsMass(1.0f);
-            model->setPhysicsRestitution(0.3f);
-            model->setPhysicsFriction(0.6f);
+            if (isTerrain)
+            {
+                attachTerrain(model);
+            }
+            else
+            {
+                model->enablePhysics(PhysicsBodyType::Dynamic);
+                model->setPhysicsMass(1.0f);
+                model->setPhysicsRestitution(0.3f);
+                model->setPhysicsFriction(0.6f);
+            }
 
             auto createAction = std::make_unique<CreateAction>(model, m_gameObjects);
             m_undoRedoSystem->executeAction(std::move(createAction));
@@ -1455,6 +1542,18 @@ void dx3d::Game::spawnModel(const std::string& filename)
     }
 }
 
+void dx3d::Game::attachTerrain(const std::shared_ptr<Model>& model)
+{
+    auto heightMap = HeightMap::LoadFromGridOBJ(ModelParser::findAssetPath(model->getFilePath()));
+    if (!heightMap)
+    {
+        DX3DLogWarning(("Not a regular grid, no terrain collision for " + model->getFilePath()).c_str());
+        return;
+    }
+
+    model->enableTerrain(heightMap);
+}
+
 void dx3d::Game::spawnPlane()
 {
     Vector3 position(0.0f, 0.0f, 0.0f);
@@ -1526,7 +1625,7 @@ std::shared_ptr<dx3d::Texture2D> dx3d::Game::loadTexture(const std::string& file
 
 void dx3d::Game::setupMaterialForObject(std::shared_ptr<AGameObject> gameObject, DeviceContext& deviceContext)
 {
-    auto& componentManager = ComponentManager::getInstance();
+    auto& componentManager = m_world.getComponentManager();
     auto* materialComp = componentManager.getComponent<MaterialComponent>(gameObject->getEntity().getID());
 
     ModelMaterialConstants mmc;
@@ -31,6 +31,7 @@ namespace dx3d
     class Sphere;
     class Cylinder;
     class Capsule;
+    class Model;
     class LightObject;
     class DepthBuffer;
     class SceneCamera;
@@ -47,6 +48,9 @@ namespace dx3d
     class Logger;
     class UndoRedoSystem;
     class Texture2D;
+    class ThreadPool;
+    class SystemScheduler;
+    class World;
 
     enum class SceneState;
 }
@@ -116,6 +120,7 @@ namespace dx3d
         void PrintMatrix(const char* name, const Matrix4x4& mat);
         void createRenderingResources();
         void update();
+        void registerSystems();
         void processInput(float deltaTime);
         void alignGameCameraWithView();
 
@@ -127,6 +132,8 @@ namespace dx3d
         void spawnCylinder();
         void spawnPlane();
         void spawnModel(const std::string& filename);
+        // Gives a model loaded from a regular-grid OBJ heightfield collision
+        void attachTerrain(const std::shared_ptr<Model>& model);
         void spawnDirectionalLight();
         void spawnPointLight();
         void spawnSpotLight();
@@ -148,12 +155,16 @@ namespace dx3d
 
     private:
         std::unique_ptr<Logger> m_loggerPtr{};
+        // The editor scene lives in the default world
+        World& m_world;
         std::unique_ptr<GraphicsEngine> m_graphicsEngine{};
         std::unique_ptr<Display> m_display{};
         bool m_isRunning{ true };
 
         std::unique_ptr<UIManager> m_uiManager{};
-        
+
+        std::unique_ptr<ThreadPool> m_threadPool{};
+        std::unique_ptr<SystemScheduler> m_systemScheduler{};
 
         std::unique_ptr<SceneCamera> m_sceneCamera{};
         std::shared_ptr<CameraObject> m_gameCamera{};
@@ -235,5 +246,13 @@ namespace dx3d
         Matrix4x4 m_lightProjectionMatrix;
         ID3D11SamplerState* m_shadowSamplerState = nullptr;
         int m_shadowCastingLightIndex = -1;
+
+        // Inputs of the last shadow pass, used to skip re-rendering an
+        // unchanged shadow map
+        bool m_shadowMapValid = false;
+        ComponentVersion m_shadowTransformVersion = 0;
+        size_t m_shadowObjectCount = 0;
+        const LightObject* m_shadowLight = nullptr;
+        Light m_shadowLightData{};
     };
 }
\ No newline at end of file
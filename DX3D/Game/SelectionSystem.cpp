@@ -1,11 +1,14 @@
 #include <../Game/SelectionSystem.h>
 #include <../Graphics/Primitives/AGameObject.h>
+#include <../Graphics/Primitives/Model.h>
 #include <../Game/SceneCamera.h>
-#include <DirectXMath.h>
+#include <../ECS/ComponentManager.h>
+#include <../Physics/PhysicsSystem.h>
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 using namespace dx3d;
-using namespace DirectX;
 
 SelectionSystem::SelectionSystem()
 {
@@ -26,42 +29,91 @@ std::shared_ptr<AGameObject> SelectionSystem::pickObject(
     float mouseX, float mouseY,
     ui32 viewportWidth, ui32 viewportHeight)
 {
+    if (viewportWidth == 0 || viewportHeight == 0)
+        return nullptr;
+
     float ndcX = (2.0f * mouseX) / viewportWidth - 1.0f;
     float ndcY = 1.0f - (2.0f * mouseY) / viewportHeight;
 
-    XMVECTOR rayClip = XMVectorSet(ndcX, ndcY, -1.0f, 1.0f);
-
+    // Straight from the camera basis, no matrix inverses needed
     float aspectRatio = static_cast<float>(viewportWidth) / viewportHeight;
-    XMMATRIX projMatrix = Matrix4x4::CreatePerspectiveFovLH(1.0472f, aspectRatio, 0.1f, 100.0f).toXMMatrix();
-    XMMATRIX invProj = XMMatrixInverse(nullptr, projMatrix);
-
-    XMVECTOR rayView = XMVector4Transform(rayClip, invProj);
-    rayView = XMVectorSet(XMVectorGetX(rayView), XMVectorGetY(rayView), -1.0f, 0.0f);
-
-    XMMATRIX invView = XMMatrixInverse(nullptr, camera.getViewMatrix().toXMMatrix());
-    XMVECTOR rayWorld = XMVector4Transform(rayView, invView);
-    XMVECTOR rayDir = XMVector3Normalize(rayWorld);
+    float tanHalfFov = std::tan(PICK_FOV * 0.5f);
 
     Vector3 rayOrigin = camera.getPosition();
-    Vector3 rayDirection;
-    XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&rayDirection), rayDir);
+    Vector3 rayDirection = Vector3::Normalize(camera.getForward() +
+        camera.getRight() * (ndcX * tanHalfFov * aspectRatio) +
+        camera.getUp() * (ndcY * tanHalfFov));
 
     std::shared_ptr<AGameObject> closestObject = nullptr;
-    float closestT = std::numeric_limits<float>::max();
+    float closestT = PICK_DISTANCE;
 
-    for (const auto& object : objects)
+    RaycastHit hit;
+    if (PhysicsSystem::getInstance().raycast(rayOrigin, rayDirection, PICK_DISTANCE, hit))
+    {
+        if (auto object = AGameObject::fromEntity(hit.entity))
+        {
+            closestT = hit.distance;
+            closestObject = object;
+        }
+    }
+
+    if (isBVHStale(objects))
+        rebuildBVH(objects);
+
+    if (m_bvhNodes.empty())
+        return closestObject;
+
+    // Nearest-first traversal; anything entered beyond the closest hit so
+    // far is skipped
+    m_traversalStack.clear();
+    m_traversalStack.push_back(0);
+
+    while (!m_traversalStack.empty())
     {
-        Vector3 objectPos = object->getPosition();
-        Vector3 aabbMin = objectPos - Vector3(0.5f, 0.5f, 0.5f);
-        Vector3 aabbMax = objectPos + Vector3(0.5f, 0.5f, 0.5f);
+        const BVHNode& node = m_bvhNodes[m_traversalStack.back()];
+        m_traversalStack.pop_back();
+
+        float entryT;
+        if (!rayIntersectsAABB(rayOrigin, rayDirection, node.boundsMin, node.boundsMax, entryT) || entryT >= closestT)
+            continue;
 
-        float t;
-        if (rayIntersectsAABB(rayOrigin, rayDirection, aabbMin, aabbMax, t))
+        if (node.count == 0)
         {
-            if (t < closestT)
+            const BVHNode& left = m_bvhNodes[node.first];
+            const BVHNode& right = m_bvhNodes[node.first + 1];
+
+            float leftT = std::numeric_limits<float>::max();
+            float rightT = std::numeric_limits<float>::max();
+            bool hitLeft = rayIntersectsAABB(rayOrigin, rayDirection, left.boundsMin, left.boundsMax, leftT);
+            bool hitRight = rayIntersectsAABB(rayOrigin, rayDirection, right.boundsMin, right.boundsMax, rightT);
+
+            // The nearer child goes on top
+            if (hitLeft && hitRight && leftT < rightT)
+            {
+                m_traversalStack.push_back(node.first + 1);
+                m_traversalStack.push_back(node.first);
+            }
+            else
+            {
+                if (hitLeft)
+                    m_traversalStack.push_back(node.first);
+                if (hitRight)
+                    m_traversalStack.push_back(node.first + 1);
+            }
+            continue;
+        }
+
+        for (ui32 i = node.first; i < node.first + node.count; ++i)
+        {
+            auto object = m_bvhItems[i].object.lock();
+            if (!object)
+                continue;
+
+            float t;
+            if (intersectObject(*object, rayOrigin, rayDirection, closestT, t))
             {
                 closestT = t;
-                closestObject = object;
+                closestObject = std::move(object);
             }
         }
     }
@@ -69,6 +121,238 @@ std::shared_ptr<AGameObject> SelectionSystem::pickObject(
     return closestObject;
 }
 
+bool SelectionSystem::isBVHStale(const std::vector<std::shared_ptr<AGameObject>>& objects) const
+{
+    if (!m_bvhBuilt || objects.size() != m_bvhSource.size())
+        return true;
+
+    auto& componentManager = ComponentManager::getInstance();
+    if (componentManager.getVersion<TransformComponent>() != m_bvhTransformVersion ||
+        componentManager.getComponentArray<PhysicsComponent>()->getStructureVersion() != m_bvhPhysicsVersion)
+        return true;
+
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        if (objects[i].get() != m_bvhSource[i])
+            return true;
+    }
+    return false;
+}
+
+void SelectionSystem::rebuildBVH(const std::vector<std::shared_ptr<AGameObject>>& objects)
+{
+    auto& componentManager = ComponentManager::getInstance();
+    m_bvhTransformVersion = componentManager.getVersion<TransformComponent>();
+    m_bvhPhysicsVersion = componentManager.getComponentArray<PhysicsComponent>()->getStructureVersion();
+    m_bvhBuilt = true;
+
+    m_bvhSource.clear();
+    m_bvhItems.clear();
+    m_bvhNodes.clear();
+
+    for (const auto& object : objects)
+    {
+        m_bvhSource.push_back(object.get());
+
+        // The physics raycast already covers these
+        if (!object || object->hasPhysics())
+            continue;
+
+        Vector3 localMin;
+        Vector3 localMax;
+        object->getLocalBounds(localMin, localMax);
+        Matrix4x4 world = object->getWorldMatrix();
+
+        BVHItem item;
+        item.object = object;
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            Vector3 point(
+                (corner & 1) ? localMax.x : localMin.x,
+                (corner & 2) ? localMax.y : localMin.y,
+                (corner & 4) ? localMax.z : localMin.z);
+            point = Matrix4x4::TransformPoint(point, world);
+
+            item.boundsMin = (corner == 0) ? point : Vector3::Min(item.boundsMin, point);
+            item.boundsMax = (corner == 0) ? point : Vector3::Max(item.boundsMax, point);
+        }
+        item.center = (item.boundsMin + item.boundsMax) * 0.5f;
+        m_bvhItems.push_back(std::move(item));
+    }
+
+    if (m_bvhItems.empty())
+        return;
+
+    m_bvhNodes.reserve(2 * m_bvhItems.size());
+    m_bvhNodes.emplace_back();
+    buildNode(m_bvhNodes, m_bvhItems, 0, 0, static_cast<ui32>(m_bvhItems.size()));
+}
+
+const SelectionSystem::MeshBVH& SelectionSystem::getMeshBVH(const CollisionMesh& mesh)
+{
+    auto [it, inserted] = m_meshBVHs.try_emplace(mesh.sourcePath);
+    MeshBVH& bvh = it->second;
+    if (!inserted)
+        return bvh;
+
+    const std::vector<Vector3>& positions = mesh.positions;
+    bvh.triangles.reserve(mesh.indices.size() / 3);
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        const Vector3& v0 = positions[mesh.indices[i]];
+        const Vector3& v1 = positions[mesh.indices[i + 1]];
+        const Vector3& v2 = positions[mesh.indices[i + 2]];
+
+        TriangleItem item;
+        item.firstIndex = static_cast<ui32>(i);
+        item.boundsMin = Vector3::Min(Vector3::Min(v0, v1), v2);
+        item.boundsMax = Vector3::Max(Vector3::Max(v0, v1), v2);
+        item.center = (item.boundsMin + item.boundsMax) * 0.5f;
+        bvh.triangles.push_back(item);
+    }
+
+    if (bvh.triangles.empty())
+        return bvh;
+
+    bvh.nodes.reserve(2 * bvh.triangles.size());
+    bvh.nodes.emplace_back();
+    buildNode(bvh.nodes, bvh.triangles, 0, 0, static_cast<ui32>(bvh.triangles.size()));
+    return bvh;
+}
+
+template <typename Item>
+void SelectionSystem::buildNode(std::vector<BVHNode>& nodes, std::vector<Item>& items, ui32 nodeIndex, ui32 first, ui32 count)
+{
+    Vector3 boundsMin = items[first].boundsMin;
+    Vector3 boundsMax = items[first].boundsMax;
+    Vector3 centerMin = items[first].center;
+    Vector3 centerMax = items[first].center;
+    for (ui32 i = first + 1; i < first + count; ++i)
+    {
+        boundsMin = Vector3::Min(boundsMin, items[i].boundsMin);
+        boundsMax = Vector3::Max(boundsMax, items[i].boundsMax);
+        centerMin = Vector3::Min(centerMin, items[i].center);
+        centerMax = Vector3::Max(centerMax, items[i].center);
+    }
+
+    nodes[nodeIndex].boundsMin = boundsMin;
+    nodes[nodeIndex].boundsMax = boundsMax;
+
+    if (count <= BVH_LEAF_SIZE)
+    {
+        nodes[nodeIndex].first = first;
+        nodes[nodeIndex].count = count;
+        return;
+    }
+
+    // Median split along the widest spread of centers
+    Vector3 extent = centerMax - centerMin;
+    int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+    auto centerOn = [axis](const Item& item)
+        {
+            return axis == 0 ? item.center.x : (axis == 1 ? item.center.y : item.center.z);
+        };
+
+    ui32 half = count / 2;
+    std::nth_element(items.begin() + first, items.begin() + first + half, items.begin() + first + count,
+        [&centerOn](const Item& a, const Item& b) { return centerOn(a) < centerOn(b); });
+
+    ui32 leftIndex = static_cast<ui32>(nodes.size());
+    nodes.emplace_back();
+    nodes.emplace_back();
+    nodes[nodeIndex].first = leftIndex;
+    nodes[nodeIndex].count = 0;
+
+    buildNode(nodes, items, leftIndex, first, half);
+    buildNode(nodes, items, leftIndex + 1, first + half, count - half);
+}
+
+bool SelectionSystem::intersectObject(const AGameObject& object, const Vector3& rayOrigin, const Vector3& rayDir,
+    float maxT, float& t)
+{
+    // In object space the ray keeps its parameter, so t stays a world distance
+    Matrix4x4 worldInverse = Matrix4x4::Inverse(object.getWorldMatrix());
+    Vector3 localOrigin = Matrix4x4::TransformPoint(rayOrigin, worldInverse);
+    Vector3 localDir = Matrix4x4::TransformNormal(rayDir, worldInverse);
+
+    Vector3 localMin;
+    Vector3 localMax;
+    object.getLocalBounds(localMin, localMax);
+
+    float boxT;
+    if (!rayIntersectsAABB(localOrigin, localDir, localMin, localMax, boxT) || boxT >= maxT)
+        return false;
+
+    const auto* model = dynamic_cast<const Model*>(&object);
+    const CollisionMesh* mesh = model ? model->getCollisionMesh().get() : nullptr;
+    if (!mesh || mesh->indices.empty())
+    {
+        t = boxT;
+        return true;
+    }
+
+    const MeshBVH& bvh = getMeshBVH(*mesh);
+    if (bvh.nodes.empty())
+        return false;
+
+    // Same nearest-first walk as the object hierarchy, over triangles
+    bool found = false;
+    t = maxT;
+    const std::vector<Vector3>& positions = mesh->positions;
+    m_meshTraversalStack.clear();
+    m_meshTraversalStack.push_back(0);
+
+    while (!m_meshTraversalStack.empty())
+    {
+        const BVHNode& node = bvh.nodes[m_meshTraversalStack.back()];
+        m_meshTraversalStack.pop_back();
+
+        float entryT;
+        if (!rayIntersectsAABB(localOrigin, localDir, node.boundsMin, node.boundsMax, entryT) || entryT >= t)
+            continue;
+
+        if (node.count == 0)
+        {
+            const BVHNode& left = bvh.nodes[node.first];
+            const BVHNode& right = bvh.nodes[node.first + 1];
+
+            float leftT = std::numeric_limits<float>::max();
+            float rightT = std::numeric_limits<float>::max();
+            bool hitLeft = rayIntersectsAABB(localOrigin, localDir, left.boundsMin, left.boundsMax, leftT);
+            bool hitRight = rayIntersectsAABB(localOrigin, localDir, right.boundsMin, right.boundsMax, rightT);
+
+            if (hitLeft && hitRight && leftT < rightT)
+            {
+                m_meshTraversalStack.push_back(node.first + 1);
+                m_meshTraversalStack.push_back(node.first);
+            }
+            else
+            {
+                if (hitLeft)
+                    m_meshTraversalStack.push_back(node.first);
+                if (hitRight)
+                    m_meshTraversalStack.push_back(node.first + 1);
+            }
+            continue;
+        }
+
+        for (ui32 i = node.first; i < node.first + node.count; ++i)
+        {
+            ui32 index = bvh.triangles[i].firstIndex;
+            float triangleT;
+            if (rayIntersectsTriangle(localOrigin, localDir,
+                positions[mesh->indices[index]], positions[mesh->indices[index + 1]], positions[mesh->indices[index + 2]], triangleT) &&
+                triangleT < t)
+            {
+                t = triangleT;
+                found = true;
+            }
+        }
+    }
+
+    return found;
+}
+
 bool SelectionSystem::rayIntersectsAABB(const Vector3& rayOrigin, const Vector3& rayDir,
     const Vector3& aabbMin, const Vector3& aabbMax, float& t)
 {
@@ -104,4 +388,30 @@ bool SelectionSystem::rayIntersectsAABB(const Vector3& rayOrigin, const Vector3&
 
     t = tmin;
     return true;
-}
\ No newline at end of file
+}
+
+bool SelectionSystem::rayIntersectsTriangle(const Vector3& rayOrigin, const Vector3& rayDir,
+    const Vector3& v0, const Vector3& v1, const Vector3& v2, float& t)
+{
+    // Moller-Trumbore, hitting both faces
+    Vector3 edge1 = v1 - v0;
+    Vector3 edge2 = v2 - v0;
+    Vector3 p = Vector3::Cross(rayDir, edge2);
+    float determinant = Vector3::Dot(edge1, p);
+    if (std::abs(determinant) < 1e-8f)
+        return false;
+
+    float inverseDeterminant = 1.0f / determinant;
+    Vector3 s = rayOrigin - v0;
+    float u = Vector3::Dot(s, p) * inverseDeterminant;
+    if (u < 0.0f || u > 1.0f)
+        return false;
+
+    Vector3 q = Vector3::Cross(s, edge1);
+    float v = Vector3::Dot(rayDir, q) * inverseDeterminant;
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+
+    t = Vector3::Dot(edge2, q) * inverseDeterminant;
+    return t > 0.0f;
+}
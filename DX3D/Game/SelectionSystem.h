@@ -1,13 +1,17 @@
 #pragma once
 #include <../Core/Base.h>
 #include <../Math/Math.h>
+#include <../ECS/ComponentArray.h>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace dx3d
 {
     class AGameObject;
     class SceneCamera;
+    struct CollisionMesh;
 
     class SelectionSystem
     {
@@ -18,6 +22,12 @@ namespace dx3d
         void setSelectedObject(std::shared_ptr<AGameObject> object);
         std::shared_ptr<AGameObject> getSelectedObject() const { return m_selectedObject; }
 
+        // Closest object under the cursor. Objects with physics are found by
+        // a raycast into the physics world, the rest through a bounding
+        // volume hierarchy over their render bounds that is only rebuilt
+        // after transforms or the object list change. Models are hit on
+        // their triangles through a hierarchy built once per model file,
+        // other objects on their oriented bounds.
         std::shared_ptr<AGameObject> pickObject(
             const std::vector<std::shared_ptr<AGameObject>>& objects,
             const SceneCamera& camera,
@@ -25,10 +35,77 @@ namespace dx3d
             ui32 viewportWidth, ui32 viewportHeight);
 
     private:
-        bool rayIntersectsAABB(const Vector3& rayOrigin, const Vector3& rayDir,
+        // Leaves hold count items starting at first; inner nodes have a
+        // count of 0 and their children at first and first + 1
+        struct BVHNode
+        {
+            Vector3 boundsMin;
+            Vector3 boundsMax;
+            ui32 first = 0;
+            ui32 count = 0;
+        };
+
+        // Weak so the hierarchy never keeps a deleted object alive until the
+        // next rebuild
+        struct BVHItem
+        {
+            std::weak_ptr<AGameObject> object;
+            Vector3 boundsMin;
+            Vector3 boundsMax;
+            Vector3 center;
+        };
+
+        struct TriangleItem
+        {
+            ui32 firstIndex = 0;
+            Vector3 boundsMin;
+            Vector3 boundsMax;
+            Vector3 center;
+        };
+
+        // Triangle hierarchy of one collision mesh in its local space; leaves
+        // refer to triangles by their first index into the mesh's indices
+        struct MeshBVH
+        {
+            std::vector<BVHNode> nodes;
+            std::vector<TriangleItem> triangles;
+        };
+
+        // Matches the scene view projection
+        static constexpr float PICK_FOV = 1.0472f;
+        static constexpr float PICK_DISTANCE = 100.0f;
+        static constexpr ui32 BVH_LEAF_SIZE = 4;
+
+        bool isBVHStale(const std::vector<std::shared_ptr<AGameObject>>& objects) const;
+        void rebuildBVH(const std::vector<std::shared_ptr<AGameObject>>& objects);
+        const MeshBVH& getMeshBVH(const CollisionMesh& mesh);
+
+        template <typename Item>
+        static void buildNode(std::vector<BVHNode>& nodes, std::vector<Item>& items, ui32 nodeIndex, ui32 first, ui32 count);
+
+        bool intersectObject(const AGameObject& object, const Vector3& rayOrigin, const Vector3& rayDir,
+            float maxT, float& t);
+
+        static bool rayIntersectsAABB(const Vector3& rayOrigin, const Vector3& rayDir,
             const Vector3& aabbMin, const Vector3& aabbMax, float& t);
+        static bool rayIntersectsTriangle(const Vector3& rayOrigin, const Vector3& rayDir,
+            const Vector3& v0, const Vector3& v1, const Vector3& v2, float& t);
 
     private:
         std::shared_ptr<AGameObject> m_selectedObject;
+
+        std::vector<BVHNode> m_bvhNodes;
+        std::vector<BVHItem> m_bvhItems;
+        std::vector<ui32> m_traversalStack;
+
+        // What the hierarchy was built from
+        std::vector<const AGameObject*> m_bvhSource;
+        ComponentVersion m_bvhTransformVersion = 0;
+        ComponentVersion m_bvhPhysicsVersion = 0;
+        bool m_bvhBuilt = false;
+
+        // Built once per model file, like the physics system's baked meshes
+        std::unordered_map<std::string, MeshBVH> m_meshBVHs;
+        std::vector<ui32> m_meshTraversalStack;
     };
-}
\ No newline at end of file
+}
@@ -1,89 +1,90 @@
 #include <../Graphics/Primitives/AGameObject.h>
 #include <../ECS/ComponentManager.h>
+#include <../ECS/TransformHierarchy.h>
+#include <../Scene/World.h>
 #include <../Physics/PhysicsSystem.h>
 #include <../Graphics/ResourceManager.h>
 #include <../ECS/Components/MaterialComponent.h>
-#include <DirectXMath.h>
 
 using namespace dx3d;
-using namespace DirectX;
-
-EntityID AGameObject::s_nextEntityID = 1;
 
 AGameObject::AGameObject()
 {
-    m_entity = Entity(s_nextEntityID++);
-
     auto& componentManager = ComponentManager::getInstance();
+    m_entity = Entity(componentManager.createEntity());
+
     TransformComponent transform;
     transform.position = m_transform.position;
     transform.rotation = m_transform.rotation;
     transform.scale = m_transform.scale;
     componentManager.addComponent(m_entity.getID(), transform);
+    componentManager.addComponent(m_entity.getID(), GameObjectComponent{ this });
 }
 
 AGameObject::AGameObject(const Vector3& position, const Vector3& rotation, const Vector3& scale)
 {
-    m_entity = Entity(s_nextEntityID++);
+    auto& componentManager = ComponentManager::getInstance();
+    m_entity = Entity(componentManager.createEntity());
 
     m_transform.position = position;
-    m_transform.rotation = rotation;
+    m_transform.rotation = Quaternion::FromEuler(rotation);
     m_transform.scale = scale;
+    m_transform.eulerAngles = rotation;
 
-    auto& componentManager = ComponentManager::getInstance();
     TransformComponent transform;
     transform.position = position;
-    transform.rotation = rotation;
+    transform.rotation = m_transform.rotation;
     transform.scale = scale;
     componentManager.addComponent(m_entity.getID(), transform);
+    componentManager.addComponent(m_entity.getID(), GameObjectComponent{ this });
 }
 
 AGameObject::~AGameObject()
 {
-    if (hasParent())
-    {
-        if (auto parent = m_parent.lock())
-        {
-            parent->removeChild(shared_from_this());
-        }
-    }
-
-    for (auto& weakChild : m_children)
-    {
-        if (auto child = weakChild.lock())
-        {
-            child->m_parent.reset();
-        }
-    }
-
     if (hasPhysics())
     {
         disablePhysics();
     }
+    if (hasTerrain())
+    {
+        disableTerrain();
+    }
 
+    // Children keep their local transforms and become roots
     auto& componentManager = ComponentManager::getInstance();
-    componentManager.removeEntity(m_entity.getID());
+    TransformHierarchy::removeFromHierarchy(componentManager, m_entity.getID());
+    componentManager.destroyEntity(m_entity.getID());
 }
 
 void AGameObject::setPosition(const Vector3& position)
 {
     m_transform.position = position;
     syncTransformToECS();
-    updateChildrenTransforms();
 }
 
 void AGameObject::setRotation(const Vector3& rotation)
 {
-    m_transform.rotation = rotation;
+    m_transform.rotation = Quaternion::FromEuler(rotation);
+    m_transform.eulerAngles = rotation;
+    syncTransformToECS();
+}
+
+void AGameObject::setOrientation(const Quaternion& orientation)
+{
+    m_transform.rotation = Quaternion::Normalize(orientation);
+    m_transform.eulerAngles = Quaternion::ToEuler(m_transform.rotation);
     syncTransformToECS();
-    updateChildrenTransforms();
 }
 
 void AGameObject::setScale(const Vector3& scale)
 {
     m_transform.scale = scale;
     syncTransformToECS();
-    updateChildrenTransforms();
+
+    if (hasPhysics())
+    {
+        updatePhysicsShape();
+    }
 }
 
 const Vector3& AGameObject::getPosition() const
@@ -93,6 +94,12 @@ const Vector3& AGameObject::getPosition() const
 }
 
 const Vector3& AGameObject::getRotation() const
+{
+    const_cast<AGameObject*>(this)->syncTransformFromECS();
+    return m_transform.eulerAngles;
+}
+
+const Quaternion& AGameObject::getOrientation() const
 {
     const_cast<AGameObject*>(this)->syncTransformFromECS();
     return m_transform.rotation;
@@ -122,13 +129,18 @@ Vector3 AGameObject::getWorldRotation() const
         return getRotation();
     }
 
-    Vector3 worldRot = getRotation();
-    if (auto parent = m_parent.lock())
+    return Quaternion::ToEuler(getWorldOrientation());
+}
+
+Quaternion AGameObject::getWorldOrientation() const
+{
+    Quaternion worldOrientation = getOrientation();
+    if (auto parent = getParent())
     {
-        Vector3 parentWorldRot = parent->getWorldRotation();
-        worldRot = worldRot + parentWorldRot;
+        // Local rotation first, then the parent's
+        worldOrientation = parent->getWorldOrientation() * worldOrientation;
     }
-    return worldRot;
+    return worldOrientation;
 }
 
 Vector3 AGameObject::getWorldScale() const
@@ -139,7 +151,7 @@ Vector3 AGameObject::getWorldScale() const
     }
 
     Vector3 worldScale = getScale();
-    if (auto parent = m_parent.lock())
+    if (auto parent = getParent())
     {
         Vector3 parentWorldScale = parent->getWorldScale();
         worldScale.x *= parentWorldScale.x;
@@ -151,34 +163,29 @@ Vector3 AGameObject::getWorldScale() const
 
 Matrix4x4 AGameObject::getWorldMatrix() const
 {
-    const_cast<AGameObject*>(this)->syncTransformFromECS();
-
-    Matrix4x4 localMatrix = m_transform.getLocalMatrix();
-
-    if (hasParent())
-    {
-        Matrix4x4 parentWorldMatrix = getParentWorldMatrix();
-        return localMatrix * parentWorldMatrix;
-    }
+    // Served from the last world pass unless a transform or link changed since
+    World& world = World::getCurrent();
+    return world.getTransformHierarchy().getWorldMatrix(world.getComponentManager(), m_entity.getID());
+}
 
-    return localMatrix;
+Matrix4x4 AGameObject::getLocalMatrix() const
+{
+    // Cached by the hierarchy until the transform changes
+    World& world = World::getCurrent();
+    return world.getTransformHierarchy().getLocalMatrix(world.getComponentManager(), m_entity.getID());
 }
 
-Matrix4x4 AGameObject::getParentWorldMatrix() const
+void AGameObject::getLocalBounds(Vector3& boundsMin, Vector3& boundsMax) const
 {
-    if (auto parent = m_parent.lock())
-    {
-        return parent->getWorldMatrix();
-    }
-    return Matrix4x4();
+    // The unit primitives all fit in a unit cube
+    boundsMin = Vector3(-0.5f, -0.5f, -0.5f);
+    boundsMax = Vector3(0.5f, 0.5f, 0.5f);
 }
 
 void AGameObject::rotate(const Vector3& deltaRotation)
 {
     syncTransformFromECS();
-    m_transform.rotation += deltaRotation;
-    syncTransformToECS();
-    updateChildrenTransforms();
+    setRotation(m_transform.eulerAngles + deltaRotation);
 }
 
 void AGameObject::translate(const Vector3& deltaPosition)
@@ -186,7 +193,6 @@ void AGameObject::translate(const Vector3& deltaPosition)
     syncTransformFromECS();
     m_transform.position += deltaPosition;
     syncTransformToECS();
-    updateChildrenTransforms();
 }
 
 void AGameObject::setParent(std::shared_ptr<AGameObject> parent)
@@ -194,45 +200,75 @@ void AGameObject::setParent(std::shared_ptr<AGameObject> parent)
     if (parent.get() == this)
         return;
 
-    if (auto oldParent = m_parent.lock())
-    {
-        oldParent->removeChild(shared_from_this());
-    }
+    auto& componentManager = ComponentManager::getInstance();
 
     if (parent)
     {
+        if (TransformHierarchy::isAncestor(componentManager, m_entity.getID(), parent->getEntity().getID()))
+            return;
+
         Vector3 worldPos = getWorldPosition();
-        Vector3 worldRot = getWorldRotation();
+        Quaternion worldOrientation = getWorldOrientation();
         Vector3 worldScale = getWorldScale();
 
-        m_parent = parent;
-        parent->addChild(shared_from_this());
+        TransformHierarchy::setParent(componentManager, m_entity.getID(), parent->getEntity().getID());
 
         setWorldPosition(worldPos);
-        setWorldRotation(worldRot);
+        setWorldOrientation(worldOrientation);
         setWorldScale(worldScale);
     }
     else
     {
-        m_parent.reset();
+        TransformHierarchy::detach(componentManager, m_entity.getID());
     }
 }
 
 void AGameObject::removeParent()
 {
-    if (auto parent = m_parent.lock())
-    {
-        Vector3 worldPos = getWorldPosition();
-        Vector3 worldRot = getWorldRotation();
-        Vector3 worldScale = getWorldScale();
+    if (!hasParent())
+        return;
 
-        parent->removeChild(shared_from_this());
-        m_parent.reset();
+    Vector3 worldPos = getWorldPosition();
+    Quaternion worldOrientation = getWorldOrientation();
+    Vector3 worldScale = getWorldScale();
 
-        setPosition(worldPos);
-        setRotation(worldRot);
-        setScale(worldScale);
-    }
+    TransformHierarchy::detach(ComponentManager::getInstance(), m_entity.getID());
+
+    setPosition(worldPos);
+    setOrientation(worldOrientation);
+    setScale(worldScale);
+}
+
+std::shared_ptr<AGameObject> AGameObject::getParent() const
+{
+    auto& componentManager = ComponentManager::getInstance();
+    return fromEntity(TransformHierarchy::getParent(componentManager, m_entity.getID()));
+}
+
+bool AGameObject::hasParent() const
+{
+    return TransformHierarchy::getParent(ComponentManager::getInstance(), m_entity.getID()) != INVALID_ENTITY;
+}
+
+std::vector<std::shared_ptr<AGameObject>> AGameObject::getChildren() const
+{
+    auto& componentManager = ComponentManager::getInstance();
+
+    std::vector<std::shared_ptr<AGameObject>> children;
+    children.reserve(TransformHierarchy::getChildCount(componentManager, m_entity.getID()));
+    TransformHierarchy::forEachChild(componentManager, m_entity.getID(), [&](EntityID child)
+        {
+            if (auto object = fromEntity(child))
+            {
+                children.push_back(std::move(object));
+            }
+        });
+    return children;
+}
+
+bool AGameObject::hasChildren() const
+{
+    return TransformHierarchy::getChildCount(ComponentManager::getInstance(), m_entity.getID()) > 0;
 }
 
 void AGameObject::addChild(std::shared_ptr<AGameObject> child)
@@ -240,26 +276,21 @@ void AGameObject::addChild(std::shared_ptr<AGameObject> child)
     if (!child || child.get() == this)
         return;
 
-    auto it = std::find_if(m_children.begin(), m_children.end(),
-        [&child](const std::weak_ptr<AGameObject>& wptr) {
-            return !wptr.expired() && wptr.lock() == child;
-        });
+    child->setParent(shared_from_this());
+}
 
-    if (it == m_children.end())
+void AGameObject::removeChild(std::shared_ptr<AGameObject> child)
+{
+    if (child && child->getParent().get() == this)
     {
-        m_children.push_back(child);
+        child->removeParent();
     }
 }
 
-void AGameObject::removeChild(std::shared_ptr<AGameObject> child)
+std::shared_ptr<AGameObject> AGameObject::fromEntity(EntityID entity)
 {
-    m_children.erase(
-        std::remove_if(m_children.begin(), m_children.end(),
-            [&child](const std::weak_ptr<AGameObject>& wptr) {
-                return wptr.expired() || wptr.lock() == child;
-            }),
-        m_children.end()
-    );
+    const auto* link = ComponentManager::getInstance().getComponent<GameObjectComponent>(entity);
+    return (link && link->object) ? link->object->weak_from_this().lock() : nullptr;
 }
 
 void AGameObject::setWorldPosition(const Vector3& worldPos)
@@ -270,19 +301,12 @@ void AGameObject::setWorldPosition(const Vector3& worldPos)
         return;
     }
 
-    if (auto parent = m_parent.lock())
+    if (auto parent = getParent())
     {
-        Matrix4x4 parentWorld = parent->getWorldMatrix();
-        XMMATRIX xmParentWorld = parentWorld.toXMMatrix();
-        XMMATRIX xmParentWorldInv = XMMatrixInverse(nullptr, xmParentWorld);
+        Matrix4x4 parentWorldInv = Matrix4x4::Inverse(parent->getWorldMatrix());
+        Vector3 localPos = Matrix4x4::TransformPoint(worldPos, parentWorldInv);
 
-        XMVECTOR worldPosVec = XMVectorSet(worldPos.x, worldPos.y, worldPos.z, 1.0f);
-        XMVECTOR localPosVec = XMVector3Transform(worldPosVec, xmParentWorldInv);
-
-        XMFLOAT3 localPos;
-        XMStoreFloat3(&localPos, localPosVec);
-
-        setPosition(Vector3(localPos.x, localPos.y, localPos.z));
+        setPosition(localPos);
     }
 }
 
@@ -294,11 +318,19 @@ void AGameObject::setWorldRotation(const Vector3& worldRot)
         return;
     }
 
-    if (auto parent = m_parent.lock())
+    setWorldOrientation(Quaternion::FromEuler(worldRot));
+}
+
+void AGameObject::setWorldOrientation(const Quaternion& worldOrientation)
+{
+    if (auto parent = getParent())
     {
-        Vector3 parentWorldRot = parent->getWorldRotation();
-        setRotation(worldRot - parentWorldRot);
+        Quaternion parentWorldInv = Quaternion::Conjugate(parent->getWorldOrientation());
+        setOrientation(parentWorldInv * worldOrientation);
+        return;
     }
+
+    setOrientation(worldOrientation);
 }
 
 void AGameObject::setWorldScale(const Vector3& worldScale)
@@ -309,7 +341,7 @@ void AGameObject::setWorldScale(const Vector3& worldScale)
         return;
     }
 
-    if (auto parent = m_parent.lock())
+    if (auto parent = getParent())
     {
         Vector3 parentWorldScale = parent->getWorldScale();
         Vector3 localScale;
@@ -320,22 +352,12 @@ void AGameObject::setWorldScale(const Vector3& worldScale)
     }
 }
 
-void AGameObject::updateChildrenTransforms()
-{
-    for (auto& weakChild : m_children)
-    {
-        if (auto child = weakChild.lock())
-        {
-            child->updateChildrenTransforms();
-        }
-    }
-}
-
 void AGameObject::enablePhysics(PhysicsBodyType bodyType)
 {
     if (hasPhysics())
     {
-        disablePhysics();
+        setPhysicsBodyType(bodyType);
+        return;
     }
 
     PhysicsComponent physicsComp = createPhysicsComponent();
@@ -358,6 +380,59 @@ bool AGameObject::hasPhysics() const
     return componentManager.hasComponent<PhysicsComponent>(m_entity.getID());
 }
 
+void AGameObject::enableTerrain(std::shared_ptr<const HeightMap> heightMap)
+{
+    if (!heightMap)
+        return;
+
+    disableTerrain();
+
+    Vector3 scale = getWorldScale();
+    if (scale.x != 1.0f || scale.y != 1.0f || scale.z != 1.0f)
+    {
+        auto scaled = std::make_shared<HeightMap>(*heightMap);
+        scaled->cellSizeX *= scale.x;
+        scaled->cellSizeZ *= scale.z;
+        scaled->origin = Vector3(heightMap->origin.x * scale.x, heightMap->origin.y * scale.y, heightMap->origin.z * scale.z);
+        for (float& height : scaled->heights)
+        {
+            height *= scale.y;
+        }
+        heightMap = scaled;
+    }
+
+    TerrainComponent terrain;
+    terrain.heightMap = heightMap;
+    PhysicsSystem::getInstance().addTerrain(m_entity.getID(), terrain);
+}
+
+void AGameObject::disableTerrain()
+{
+    if (hasTerrain())
+    {
+        PhysicsSystem::getInstance().removeTerrain(m_entity.getID());
+    }
+}
+
+bool AGameObject::hasTerrain() const
+{
+    auto& componentManager = ComponentManager::getInstance();
+    return componentManager.hasComponent<TerrainComponent>(m_entity.getID());
+}
+
+void AGameObject::setPhysicsBodyType(PhysicsBodyType bodyType)
+{
+    auto& componentManager = ComponentManager::getInstance();
+    auto* physicsComp = componentManager.getComponent<PhysicsComponent>(m_entity.getID());
+
+    if (physicsComp && physicsComp->bodyType != bodyType)
+    {
+        PhysicsComponent component = *physicsComp;
+        component.bodyType = bodyType;
+        PhysicsSystem::getInstance().updatePhysicsComponent(m_entity.getID(), component);
+    }
+}
+
 void AGameObject::setPhysicsMass(float mass)
 {
     auto& componentManager = ComponentManager::getInstance();
@@ -366,10 +441,7 @@ void AGameObject::setPhysicsMass(float mass)
     if (physicsComp)
     {
         physicsComp->mass = mass;
-        if (physicsComp->rigidBody && physicsComp->bodyType == PhysicsBodyType::Dynamic)
-        {
-            physicsComp->rigidBody->setMass(mass);
-        }
+        PhysicsSystem::getInstance().applyMaterial(m_entity.getID());
     }
 }
 
@@ -381,10 +453,7 @@ void AGameObject::setPhysicsRestitution(float restitution)
     if (physicsComp)
     {
         physicsComp->restitution = restitution;
-        if (physicsComp->collider)
-        {
-            physicsComp->collider->getMaterial().setBounciness(restitution);
-        }
+        PhysicsSystem::getInstance().applyMaterial(m_entity.getID());
     }
 }
 
@@ -396,52 +465,31 @@ void AGameObject::setPhysicsFriction(float friction)
     if (physicsComp)
     {
         physicsComp->friction = friction;
-        if (physicsComp->collider)
-        {
-            physicsComp->collider->getMaterial().setFrictionCoefficient(friction);
-        }
+        PhysicsSystem::getInstance().applyMaterial(m_entity.getID());
     }
 }
 
 void AGameObject::applyForce(const Vector3& force)
 {
-    auto& componentManager = ComponentManager::getInstance();
-    auto* physicsComp = componentManager.getComponent<PhysicsComponent>(m_entity.getID());
-
-    if (physicsComp && physicsComp->rigidBody)
+    if (hasPhysics())
     {
-        rp3d::Vector3 reactForce = PhysicsSystem::toReactVector(force);
-        physicsComp->rigidBody->applyWorldForceAtCenterOfMass(reactForce);
+        PhysicsSystem::getInstance().applyForce(m_entity.getID(), force);
     }
 }
 
 void AGameObject::applyImpulse(const Vector3& impulse)
 {
-    auto& componentManager = ComponentManager::getInstance();
-    auto* physicsComp = componentManager.getComponent<PhysicsComponent>(m_entity.getID());
-
-    if (physicsComp && physicsComp->rigidBody)
+    if (hasPhysics())
     {
-        rp3d::Vector3 currentVelocity = physicsComp->rigidBody->getLinearVelocity();
-
-        rp3d::Vector3 reactImpulse = PhysicsSystem::toReactVector(impulse);
-        float mass = physicsComp->rigidBody->getMass();
-
-        rp3d::Vector3 velocityChange = reactImpulse / mass;
-        rp3d::Vector3 newVelocity = currentVelocity + velocityChange;
-
-        physicsComp->rigidBody->setLinearVelocity(newVelocity);
+        PhysicsSystem::getInstance().applyImpulse(m_entity.getID(), impulse);
     }
 }
 
 Vector3 AGameObject::getLinearVelocity() const
 {
-    auto& componentManager = ComponentManager::getInstance();
-    auto* physicsComp = componentManager.getComponent<PhysicsComponent>(m_entity.getID());
-
-    if (physicsComp && physicsComp->rigidBody)
+    if (hasPhysics())
     {
-        return PhysicsSystem::fromReactVector(physicsComp->rigidBody->getLinearVelocity());
+        return PhysicsSystem::getInstance().getLinearVelocity(m_entity.getID());
     }
 
     return Vector3(0, 0, 0);
@@ -449,13 +497,9 @@ Vector3 AGameObject::getLinearVelocity() const
 
 void AGameObject::setLinearVelocity(const Vector3& velocity)
 {
-    auto& componentManager = ComponentManager::getInstance();
-    auto* physicsComp = componentManager.getComponent<PhysicsComponent>(m_entity.getID());
-
-    if (physicsComp && physicsComp->rigidBody)
+    if (hasPhysics())
     {
-        rp3d::Vector3 reactVelocity = PhysicsSystem::toReactVector(velocity);
-        physicsComp->rigidBody->setLinearVelocity(reactVelocity);
+        PhysicsSystem::getInstance().setLinearVelocity(m_entity.getID(), velocity);
     }
 }
 
@@ -505,28 +549,67 @@ PhysicsComponent AGameObject::createPhysicsComponent() const
     case CollisionShapeType::Plane:
         component.boxHalfExtents = Vector3(scale.x * 0.5f, 0.01f, scale.z * 0.5f);
         break;
+
+    case CollisionShapeType::ConvexHull:
+    case CollisionShapeType::TriangleMesh:
+        component.meshScale = scale;
+        break;
     }
 
     return component;
 }
 
+void AGameObject::updatePhysicsShape()
+{
+    auto& componentManager = ComponentManager::getInstance();
+    const auto* physicsComp = componentManager.getComponent<PhysicsComponent>(m_entity.getID());
+    if (!physicsComp)
+        return;
+
+    // Fresh shape parameters for the current scale, everything else kept
+    PhysicsComponent component = createPhysicsComponent();
+    component.bodyType = physicsComp->bodyType;
+    component.mass = physicsComp->mass;
+    component.restitution = physicsComp->restitution;
+    component.friction = physicsComp->friction;
+    component.isTrigger = physicsComp->isTrigger;
+    component.eventTags = physicsComp->eventTags;
+    component.linearVelocity = physicsComp->linearVelocity;
+
+    PhysicsSystem::getInstance().updatePhysicsComponent(m_entity.getID(), component);
+}
+
 void AGameObject::syncTransformFromECS()
 {
     auto& componentManager = ComponentManager::getInstance();
-    auto* transformComp = componentManager.getComponent<TransformComponent>(m_entity.getID());
+    auto* transforms = componentManager.getComponentArray<TransformComponent>();
 
-    if (transformComp)
+    // Skip the copy unless something else (physics, scene load, commands)
+    // wrote the component since we last pulled or pushed it
+    ComponentVersion version = transforms->getChangeVersion(m_entity.getID());
+    if (version == 0 || version == m_syncedTransformVersion)
+        return;
+
+    const auto* transformComp = transforms->getComponent(m_entity.getID());
+    m_transform.position = transformComp->position;
+    m_transform.scale = transformComp->scale;
+
+    // Only rebuild the Euler view when the orientation actually moved
+    const Quaternion& rotation = transformComp->rotation;
+    if (rotation.x != m_transform.rotation.x || rotation.y != m_transform.rotation.y ||
+        rotation.z != m_transform.rotation.z || rotation.w != m_transform.rotation.w)
     {
-        m_transform.position = transformComp->position;
-        m_transform.rotation = transformComp->rotation;
-        m_transform.scale = transformComp->scale;
+        m_transform.rotation = rotation;
+        m_transform.eulerAngles = Quaternion::ToEuler(rotation);
     }
+    m_syncedTransformVersion = version;
 }
 
 void AGameObject::syncTransformToECS()
 {
     auto& componentManager = ComponentManager::getInstance();
-    auto* transformComp = componentManager.getComponent<TransformComponent>(m_entity.getID());
+    auto* transforms = componentManager.getComponentArray<TransformComponent>();
+    auto* transformComp = transforms->getComponent(m_entity.getID());
 
     if (transformComp)
     {
@@ -534,32 +617,17 @@ void AGameObject::syncTransformToECS()
         transformComp->rotation = m_transform.rotation;
         transformComp->scale = m_transform.scale;
 
+        // Our local copy is now the latest write, so the next pull is a no-op
+        transforms->markChanged(m_entity.getID());
+        m_syncedTransformVersion = transforms->getChangeVersion(m_entity.getID());
+
         if (hasPhysics())
         {
-            auto* physicsComp = componentManager.getComponent<PhysicsComponent>(m_entity.getID());
-            if (physicsComp && physicsComp->rigidBody)
-            {
-                rp3d::Vector3 position = PhysicsSystem::toReactVector(m_transform.position);
-                rp3d::Quaternion orientation = PhysicsSystem::toReactQuaternion(m_transform.rotation);
-                rp3d::Transform transform(position, orientation);
-                physicsComp->rigidBody->setTransform(transform);
-            }
+            PhysicsSystem::getInstance().setBodyTransform(m_entity.getID(), m_transform.position, m_transform.rotation);
         }
     }
 }
 
-Matrix4x4 AGameObject::Transform::getLocalMatrix() const
-{
-    Matrix4x4 scaleMatrix = Matrix4x4::CreateScale(scale);
-    Matrix4x4 rotationX = Matrix4x4::CreateRotationX(rotation.x);
-    Matrix4x4 rotationY = Matrix4x4::CreateRotationY(rotation.y);
-    Matrix4x4 rotationZ = Matrix4x4::CreateRotationZ(rotation.z);
-    Matrix4x4 translationMatrix = Matrix4x4::CreateTranslation(position);
-
-    Matrix4x4 result = scaleMatrix * rotationZ * rotationY * rotationX * translationMatrix;
-    return result;
-}
-
 void AGameObject::setEnabled(bool enabled)
 {
     if (m_enabled == enabled)
@@ -3,8 +3,10 @@
 #include <../Graphics/IndexBuffer.h>
 #include <../Math/Math.h>
 #include <../ECS/Entity.h>
+#include <../ECS/ComponentArray.h>
 #include <../ECS/Components/TransformComponent.h>
 #include <../ECS/Components/PhysicsComponent.h>
+#include <../ECS/Components/TerrainComponent.h>
 #include <../ECS/Components/MaterialComponent.h>
 #include <../Graphics/GraphicsEngine.h>
 #include <../Graphics/RenderSystem.h>
@@ -15,16 +17,26 @@
 
 namespace dx3d
 {
+    class AGameObject;
+
+    // Back-reference from an entity to the AGameObject that owns it, so
+    // hierarchy links stored in the ECS can be resolved to objects
+    struct GameObjectComponent
+    {
+        AGameObject* object = nullptr;
+    };
+
     class AGameObject : public std::enable_shared_from_this<AGameObject>
     {
     public:
         struct Transform
         {
             Vector3 position{ 0.0f, 0.0f, 0.0f };
-            Vector3 rotation{ 0.0f, 0.0f, 0.0f };
+            Quaternion rotation;
             Vector3 scale{ 1.0f, 1.0f, 1.0f };
-
-            Matrix4x4 getLocalMatrix() const;
+            // Editor-facing Euler view of rotation in radians, kept in step
+            // with every write so typed-in angles survive unchanged
+            Vector3 eulerAngles{ 0.0f, 0.0f, 0.0f };
         };
 
     public:
@@ -34,22 +46,28 @@ namespace dx3d
 
         void setPosition(const Vector3& position);
         void setRotation(const Vector3& rotation);
+        void setOrientation(const Quaternion& orientation);
         void setScale(const Vector3& scale);
 
         const Vector3& getPosition() const;
         const Vector3& getRotation() const;
+        const Quaternion& getOrientation() const;
         const Vector3& getScale() const;
 
         const Vector3& getLocalPosition() const { return m_transform.position; }
-        const Vector3& getLocalRotation() const { return m_transform.rotation; }
+        const Vector3& getLocalRotation() const { return m_transform.eulerAngles; }
         const Vector3& getLocalScale() const { return m_transform.scale; }
 
         Vector3 getWorldPosition() const;
         Vector3 getWorldRotation() const;
+        Quaternion getWorldOrientation() const;
         Vector3 getWorldScale() const;
 
         Matrix4x4 getWorldMatrix() const;
-        Matrix4x4 getLocalMatrix() const { return m_transform.getLocalMatrix(); }
+        Matrix4x4 getLocalMatrix() const;
+
+        // Object-space box around the rendered geometry, used for picking
+        virtual void getLocalBounds(Vector3& boundsMin, Vector3& boundsMax) const;
 
         void rotate(const Vector3& deltaRotation);
         void translate(const Vector3& deltaPosition);
@@ -61,10 +79,18 @@ namespace dx3d
         void disablePhysics();
         bool hasPhysics() const;
 
+        void setPhysicsBodyType(PhysicsBodyType bodyType);
         void setPhysicsMass(float mass);
         void setPhysicsRestitution(float restitution);
         void setPhysicsFriction(float friction);
 
+        // Heightfield ground collision from heightMap, scaled and placed by
+        // the object's transform when enabled; later moves and rotation do
+        // not carry over
+        void enableTerrain(std::shared_ptr<const HeightMap> heightMap);
+        void disableTerrain();
+        bool hasTerrain() const;
+
         void applyForce(const Vector3& force);
         void applyImpulse(const Vector3& impulse);
 
@@ -87,16 +113,21 @@ namespace dx3d
 
         void setParent(std::shared_ptr<AGameObject> parent);
         void removeParent();
-        std::shared_ptr<AGameObject> getParent() const { return m_parent.lock(); }
-        bool hasParent() const { return !m_parent.expired(); }
+        // Hierarchy links live in HierarchyComponent (see TransformHierarchy)
+        std::shared_ptr<AGameObject> getParent() const;
+        bool hasParent() const;
 
         void addChild(std::shared_ptr<AGameObject> child);
         void removeChild(std::shared_ptr<AGameObject> child);
-        const std::vector<std::weak_ptr<AGameObject>>& getChildren() const { return m_children; }
-        bool hasChildren() const { return !m_children.empty(); }
+        std::vector<std::shared_ptr<AGameObject>> getChildren() const;
+        bool hasChildren() const;
+
+        // Object owning the entity, or null if it is not an AGameObject
+        static std::shared_ptr<AGameObject> fromEntity(EntityID entity);
 
         void setWorldPosition(const Vector3& worldPos);
         void setWorldRotation(const Vector3& worldRot);
+        void setWorldOrientation(const Quaternion& worldOrientation);
         void setWorldScale(const Vector3& worldScale);
 
     protected:
@@ -105,20 +136,16 @@ namespace dx3d
 
         void syncTransformFromECS();
         void syncTransformToECS();
-        void updateChildrenTransforms();
+        // Resizes the collider to the current scale
+        void updatePhysicsShape();
 
     protected:
         Transform m_transform;
+        // Change version of the ECS transform that m_transform mirrors
+        ComponentVersion m_syncedTransformVersion = 0;
         Entity m_entity;
         bool m_enabled = true;
         bool m_hadPhysicsBeforeDisable = false;
         PhysicsBodyType m_previousBodyType = PhysicsBodyType::Dynamic;
-
-        std::weak_ptr<AGameObject> m_parent;
-        std::vector<std::weak_ptr<AGameObject>> m_children;
-
-    private:
-        static EntityID s_nextEntityID;
-        Matrix4x4 getParentWorldMatrix() const;
     };
 }
\ No newline at end of file
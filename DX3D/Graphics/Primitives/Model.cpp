@@ -66,10 +66,29 @@ void Model::update(float deltaTime)
     // Add any model-specific update logic here if needed
 }
 
+void Model::getLocalBounds(Vector3& boundsMin, Vector3& boundsMax) const
+{
+    if (!m_collisionMesh || m_collisionMesh->positions.empty())
+    {
+        AGameObject::getLocalBounds(boundsMin, boundsMax);
+        return;
+    }
+
+    boundsMin = m_collisionMesh->boundsMin;
+    boundsMax = m_collisionMesh->boundsMax;
+}
+
 CollisionShapeType Model::getCollisionShapeType() const
 {
-   
-    return CollisionShapeType::Box;
+    // Dynamic bodies get the convex hull instead (see PhysicsSystem)
+    return m_collisionMesh ? CollisionShapeType::TriangleMesh : CollisionShapeType::Box;
+}
+
+PhysicsComponent Model::createPhysicsComponent() const
+{
+    PhysicsComponent component = AGameObject::createPhysicsComponent();
+    component.collisionMesh = m_collisionMesh;
+    return component;
 }
 
 std::shared_ptr<Model> Model::LoadFromFile(
@@ -30,11 +30,16 @@ namespace dx3d
         void setName(const std::string& name) { m_name = name; }
         const std::string& getName() const { return m_name; }
 
+        // Collision geometry parsed with the meshes, shared per model file
+        void setCollisionMesh(std::shared_ptr<const CollisionMesh> collisionMesh) { m_collisionMesh = collisionMesh; }
+        const std::shared_ptr<const CollisionMesh>& getCollisionMesh() const { return m_collisionMesh; }
+
         // Check if model is ready for rendering
         bool isReadyForRendering() const;
 
         // Override virtual methods from base class
         virtual void update(float deltaTime) override;
+        virtual void getLocalBounds(Vector3& boundsMin, Vector3& boundsMax) const override;
 
         // Static factory method for loading models
         static std::shared_ptr<Model> LoadFromFile(
@@ -46,9 +51,11 @@ namespace dx3d
         std::string m_name;
         std::string m_filePath;
         std::vector<std::shared_ptr<Mesh>> m_meshes;
+        std::shared_ptr<const CollisionMesh> m_collisionMesh;
 
     protected:
         virtual CollisionShapeType getCollisionShapeType() const override;
+        virtual PhysicsComponent createPhysicsComponent() const override;
     };
 
     
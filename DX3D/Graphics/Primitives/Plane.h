@@ -31,6 +31,12 @@ namespace dx3d
         // Override virtual methods from base class if needed
         virtual void update(float deltaTime) override;
 
+        virtual void getLocalBounds(Vector3& boundsMin, Vector3& boundsMax) const override
+        {
+            boundsMin = Vector3(-0.5f, -0.01f, -0.5f);
+            boundsMax = Vector3(0.5f, 0.01f, 0.5f);
+        }
+
     protected:
         virtual CollisionShapeType getCollisionShapeType() const override
         {
@@ -1,70 +1,209 @@
 #include <../Math/Math.h>
 
 using namespace dx3d;
-using namespace DirectX;
+
+namespace
+{
+    simd::Mat4 loadMatrix(const Matrix4x4& matrix)
+    {
+        return simd::loadMatrix(&matrix.m[0][0]);
+    }
+
+    Matrix4x4 storeMatrix(const simd::Mat4& matrix)
+    {
+        Matrix4x4 result;
+        simd::storeMatrix(&result.m[0][0], matrix);
+        return result;
+    }
+}
 
 Matrix4x4 Matrix4x4::operator*(const Matrix4x4& other) const
 {
-    XMMATRIX a = toXMMatrix();
-    XMMATRIX b = other.toXMMatrix();
-    XMMATRIX result = XMMatrixMultiply(a, b);
-    return fromXMMatrix(result);
+    return storeMatrix(simd::multiply(loadMatrix(*this), loadMatrix(other)));
 }
 
 Matrix4x4 Matrix4x4::CreateTranslation(const Vector3& translation)
 {
-    XMMATRIX xmMatrix = XMMatrixTranslation(translation.x, translation.y, translation.z);
-    return fromXMMatrix(xmMatrix);
+    Matrix4x4 result;
+    result.m[3][0] = translation.x;
+    result.m[3][1] = translation.y;
+    result.m[3][2] = translation.z;
+    return result;
 }
 
 Matrix4x4 Matrix4x4::CreateRotationX(float angle)
 {
-    XMMATRIX xmMatrix = XMMatrixRotationX(angle);
-    return fromXMMatrix(xmMatrix);
+    float s = std::sin(angle), c = std::cos(angle);
+    Matrix4x4 result;
+    result.m[1][1] = c;
+    result.m[1][2] = s;
+    result.m[2][1] = -s;
+    result.m[2][2] = c;
+    return result;
 }
 
 Matrix4x4 Matrix4x4::CreateRotationY(float angle)
 {
-    XMMATRIX xmMatrix = XMMatrixRotationY(angle);
-    return fromXMMatrix(xmMatrix);
+    float s = std::sin(angle), c = std::cos(angle);
+    Matrix4x4 result;
+    result.m[0][0] = c;
+    result.m[0][2] = -s;
+    result.m[2][0] = s;
+    result.m[2][2] = c;
+    return result;
 }
 
 Matrix4x4 Matrix4x4::CreateRotationZ(float angle)
 {
-    XMMATRIX xmMatrix = XMMatrixRotationZ(angle);
-    return fromXMMatrix(xmMatrix);
+    float s = std::sin(angle), c = std::cos(angle);
+    Matrix4x4 result;
+    result.m[0][0] = c;
+    result.m[0][1] = s;
+    result.m[1][0] = -s;
+    result.m[1][1] = c;
+    return result;
 }
 
 Matrix4x4 Matrix4x4::CreateScale(const Vector3& scale)
 {
-    XMMATRIX xmMatrix = XMMatrixScaling(scale.x, scale.y, scale.z);
-    return fromXMMatrix(xmMatrix);
+    Matrix4x4 result;
+    result.m[0][0] = scale.x;
+    result.m[1][1] = scale.y;
+    result.m[2][2] = scale.z;
+    return result;
 }
 
 Matrix4x4 Matrix4x4::CreatePerspectiveFovLH(float fovY, float aspectRatio, float nearPlane, float farPlane)
 {
-    XMMATRIX xmMatrix = XMMatrixPerspectiveFovLH(fovY, aspectRatio, nearPlane, farPlane);
-    return fromXMMatrix(xmMatrix);
+    float height = 1.0f / std::tan(fovY * 0.5f);
+    float width = height / aspectRatio;
+    float range = farPlane / (farPlane - nearPlane);
+
+    Matrix4x4 result;
+    result.m[0][0] = width;
+    result.m[1][1] = height;
+    result.m[2][2] = range;
+    result.m[2][3] = 1.0f;
+    result.m[3][2] = -range * nearPlane;
+    result.m[3][3] = 0.0f;
+    return result;
+}
+
+Matrix4x4 Matrix4x4::CreateOrthographicLH(float width, float height, float nearPlane, float farPlane)
+{
+    float range = 1.0f / (farPlane - nearPlane);
+
+    Matrix4x4 result;
+    result.m[0][0] = 2.0f / width;
+    result.m[1][1] = 2.0f / height;
+    result.m[2][2] = range;
+    result.m[3][2] = -range * nearPlane;
+    return result;
 }
 
 Matrix4x4 Matrix4x4::CreateLookAtLH(const Vector3& eye, const Vector3& target, const Vector3& up)
 {
-    XMVECTOR eyeVec = XMVectorSet(eye.x, eye.y, eye.z, 1.0f);
-    XMVECTOR targetVec = XMVectorSet(target.x, target.y, target.z, 1.0f);
-    XMVECTOR upVec = XMVectorSet(up.x, up.y, up.z, 0.0f);
+    Vector3 zAxis = Vector3::Normalize(target - eye);
+    Vector3 xAxis = Vector3::Normalize(Vector3::Cross(up, zAxis));
+    Vector3 yAxis = Vector3::Cross(zAxis, xAxis);
 
-    XMMATRIX xmMatrix = XMMatrixLookAtLH(eyeVec, targetVec, upVec);
-    return fromXMMatrix(xmMatrix);
+    Matrix4x4 result;
+    result.m[0][0] = xAxis.x; result.m[0][1] = yAxis.x; result.m[0][2] = zAxis.x;
+    result.m[1][0] = xAxis.y; result.m[1][1] = yAxis.y; result.m[1][2] = zAxis.y;
+    result.m[2][0] = xAxis.z; result.m[2][1] = yAxis.z; result.m[2][2] = zAxis.z;
+    result.m[3][0] = -Vector3::Dot(xAxis, eye);
+    result.m[3][1] = -Vector3::Dot(yAxis, eye);
+    result.m[3][2] = -Vector3::Dot(zAxis, eye);
+    return result;
 }
 
+Matrix4x4 Matrix4x4::CreateTransform(const Vector3& position, const Vector3& rotation, const Vector3& scale)
+{
+    return storeMatrix(simd::composeTransform(&position.x, &rotation.x, &scale.x));
+}
+
+Matrix4x4 Matrix4x4::CreateRotation(const Quaternion& rotation)
+{
+    return CreateTransform(Vector3(), rotation, Vector3(1.0f, 1.0f, 1.0f));
+}
+
+Matrix4x4 Matrix4x4::CreateTransform(const Vector3& position, const Quaternion& rotation, const Vector3& scale)
+{
+    return storeMatrix(simd::composeTransformQuaternion(&position.x, &rotation.x, &scale.x));
+}
+
+Matrix4x4 Matrix4x4::Transpose(const Matrix4x4& matrix)
+{
+    return storeMatrix(simd::transpose(loadMatrix(matrix)));
+}
+
+Matrix4x4 Matrix4x4::Inverse(const Matrix4x4& matrix)
+{
+    simd::Mat4 result;
+    if (!simd::inverse(loadMatrix(matrix), result))
+        return Matrix4x4();
+
+    return storeMatrix(result);
+}
+
+Vector3 Matrix4x4::TransformPoint(const Vector3& point, const Matrix4x4& matrix)
+{
+    Vector3 result;
+    simd::transformPoints(matrix, &point, &result, 1);
+    return result;
+}
+
+Vector3 Matrix4x4::TransformNormal(const Vector3& vector, const Matrix4x4& matrix)
+{
+    Vector3 result;
+    simd::transformNormals(matrix, &vector, &result, 1);
+    return result;
+}
+
+Quaternion Quaternion::FromEuler(const Vector3& eulerAngles)
+{
+    float sx = std::sin(eulerAngles.x * 0.5f), cx = std::cos(eulerAngles.x * 0.5f);
+    float sy = std::sin(eulerAngles.y * 0.5f), cy = std::cos(eulerAngles.y * 0.5f);
+    float sz = std::sin(eulerAngles.z * 0.5f), cz = std::cos(eulerAngles.z * 0.5f);
+
+    // X * Y * Z in quaternion order, matching the row-vector Z, Y, X matrices
+    return Quaternion(
+        sx * cy * cz + cx * sy * sz,
+        cx * sy * cz - sx * cy * sz,
+        cx * cy * sz + sx * sy * cz,
+        cx * cy * cz - sx * sy * sz);
+}
+
+Vector3 Quaternion::ToEuler(const Quaternion& q)
+{
+    // Read back from the rotation matrix; m[2][0] is sin(y)
+    float m00 = 1.0f - 2.0f * (q.y * q.y + q.z * q.z);
+    float m10 = 2.0f * (q.x * q.y - q.w * q.z);
+    float m20 = 2.0f * (q.x * q.z + q.w * q.y);
+    float m21 = 2.0f * (q.y * q.z - q.w * q.x);
+    float m22 = 1.0f - 2.0f * (q.x * q.x + q.y * q.y);
+
+    if (std::fabs(m20) >= 0.99999f)
+    {
+        // Gimbal lock: x and z rotate about the same axis, put it all in x
+        float m11 = 1.0f - 2.0f * (q.x * q.x + q.z * q.z);
+        float m12 = 2.0f * (q.y * q.z + q.w * q.x);
+        return Vector3(std::atan2(m12, m11), std::copysign(1.57079633f, m20), 0.0f);
+    }
+
+    return Vector3(std::atan2(-m21, m22), std::asin(m20), std::atan2(-m10, m00));
+}
+
+#ifdef _WIN32
 DirectX::XMMATRIX Matrix4x4::toXMMatrix() const
 {
-    return XMLoadFloat4x4(reinterpret_cast<const XMFLOAT4X4*>(this));
+    return DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(this));
 }
 
 Matrix4x4 Matrix4x4::fromXMMatrix(const DirectX::XMMATRIX& xmMatrix)
 {
     Matrix4x4 result;
-    XMStoreFloat4x4(reinterpret_cast<XMFLOAT4X4*>(&result), xmMatrix);
+    DirectX::XMStoreFloat4x4(reinterpret_cast<DirectX::XMFLOAT4X4*>(&result), xmMatrix);
     return result;
-}
\ No newline at end of file
+}
+#endif
@@ -1,7 +1,10 @@
 #pragma once
 #include <../Core/Base.h>
+#include <../Math/SIMD.h>
 #include <cmath>
+#ifdef _WIN32
 #include <DirectXMath.h>
+#endif
 
 namespace dx3d
 {
@@ -19,7 +22,9 @@ namespace dx3d
 
         Vector3() : x(0), y(0), z(0) {}
         Vector3(float x, float y, float z) : x(x), y(y), z(z) {}
+#ifdef _WIN32
         Vector3(const DirectX::XMVECTOR& vec) : x(DirectX::XMVectorGetX(vec)), y(DirectX::XMVectorGetY(vec)), z(DirectX::XMVectorGetZ(vec)) {}
+#endif
 
         Vector3 operator+(const Vector3& other) const { return Vector3(x + other.x, y + other.y, z + other.z); }
         Vector3 operator-(const Vector3& other) const { return Vector3(x - other.x, y - other.y, z - other.z); }
@@ -52,6 +57,21 @@ namespace dx3d
             );
         }
 
+        static Vector3 Lerp(const Vector3& from, const Vector3& to, float t)
+        {
+            return from + (to - from) * t;
+        }
+
+        static Vector3 Min(const Vector3& v1, const Vector3& v2)
+        {
+            return Vector3(v1.x < v2.x ? v1.x : v2.x, v1.y < v2.y ? v1.y : v2.y, v1.z < v2.z ? v1.z : v2.z);
+        }
+
+        static Vector3 Max(const Vector3& v1, const Vector3& v2)
+        {
+            return Vector3(v1.x > v2.x ? v1.x : v2.x, v1.y > v2.y ? v1.y : v2.y, v1.z > v2.z ? v1.z : v2.z);
+        }
+
     };
 
     struct Vector4
@@ -62,6 +82,56 @@ namespace dx3d
         Vector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
     };
 
+    // Unit quaternion, same component layout and rotation sense as
+    // rp3d::Quaternion so physics can copy it without conversion
+    struct Quaternion
+    {
+        float x, y, z, w;
+
+        Quaternion() : x(0), y(0), z(0), w(1) {}
+        Quaternion(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+        // Applies other first, then this
+        Quaternion operator*(const Quaternion& other) const
+        {
+            return Quaternion(
+                w * other.x + x * other.w + y * other.z - z * other.y,
+                w * other.y - x * other.z + y * other.w + z * other.x,
+                w * other.z + x * other.y - y * other.x + z * other.w,
+                w * other.w - x * other.x - y * other.y - z * other.z);
+        }
+
+        static Quaternion Conjugate(const Quaternion& q) { return Quaternion(-q.x, -q.y, -q.z, q.w); }
+
+        static Quaternion Normalize(const Quaternion& q)
+        {
+            float len = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+            if (len > 0.0001f) {
+                return Quaternion(q.x / len, q.y / len, q.z / len, q.w / len);
+            }
+            return Quaternion();
+        }
+
+        // Normalized linear blend along the shorter arc; close enough to slerp
+        // for the small per-step rotations it is used on
+        static Quaternion Nlerp(const Quaternion& from, const Quaternion& to, float t)
+        {
+            float dot = from.x * to.x + from.y * to.y + from.z * to.z + from.w * to.w;
+            float sign = (dot < 0.0f) ? -1.0f : 1.0f;
+            return Normalize(Quaternion(
+                from.x + (to.x * sign - from.x) * t,
+                from.y + (to.y * sign - from.y) * t,
+                from.z + (to.z * sign - from.z) * t,
+                from.w + (to.w * sign - from.w) * t));
+        }
+
+        // Euler angles in radians as used by the editor and scene files:
+        // the rotation CreateRotationZ * CreateRotationY * CreateRotationX
+        // applies to row vectors
+        static Quaternion FromEuler(const Vector3& eulerAngles);
+        static Vector3 ToEuler(const Quaternion& q);
+    };
+
     struct Matrix4x4
     {
         float m[4][4];
@@ -84,11 +154,29 @@ namespace dx3d
         static Matrix4x4 CreateRotationZ(float angle);
         static Matrix4x4 CreateScale(const Vector3& scale);
         static Matrix4x4 CreatePerspectiveFovLH(float fovY, float aspectRatio, float nearPlane, float farPlane);
+        static Matrix4x4 CreateOrthographicLH(float width, float height, float nearPlane, float farPlane);
         static Matrix4x4 CreateLookAtLH(const Vector3& eye, const Vector3& target, const Vector3& up);
 
-        // Convert to DirectXMath for calculations
+        static Matrix4x4 CreateRotation(const Quaternion& rotation);
+
+        // Scale * RotationZ * RotationY * RotationX * Translation, built
+        // directly instead of through five matrices and four multiplies
+        static Matrix4x4 CreateTransform(const Vector3& position, const Vector3& rotation, const Vector3& scale);
+        static Matrix4x4 CreateTransform(const Vector3& position, const Quaternion& rotation, const Vector3& scale);
+
+        static Matrix4x4 Transpose(const Matrix4x4& matrix);
+        // Identity if the matrix is singular
+        static Matrix4x4 Inverse(const Matrix4x4& matrix);
+
+        // Row vector times matrix, with w = 1 and w = 0 respectively
+        static Vector3 TransformPoint(const Vector3& point, const Matrix4x4& matrix);
+        static Vector3 TransformNormal(const Vector3& vector, const Matrix4x4& matrix);
+
+#ifdef _WIN32
+        // Interop with code that still uses DirectXMath
         DirectX::XMMATRIX toXMMatrix() const;
         static Matrix4x4 fromXMMatrix(const DirectX::XMMATRIX& xmMatrix);
+#endif
     };
 
     // Constant buffer structure for transformation matrices
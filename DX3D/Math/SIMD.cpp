@@ -0,0 +1,227 @@
+#include <../Math/SIMD.h>
+#include <../Math/Math.h>
+
+using namespace dx3d;
+using namespace dx3d::simd;
+
+namespace
+{
+    // Writes xyz of a lane set without touching the float after it, so
+    // in-place batches stay valid
+    inline void storeVector3(Vector3& out, Vec4 v)
+    {
+        alignas(16) float values[4];
+        store(values, v);
+        out = Vector3(values[0], values[1], values[2]);
+    }
+
+#if defined(DX3D_SIMD_AVX2)
+    inline __m256 madd256(__m256 a, __m256 b, __m256 c)
+    {
+#if defined(__FMA__)
+        return _mm256_fmadd_ps(a, b, c);
+#else
+        return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+    }
+
+    inline __m256 pair(float low, float high)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(low)), _mm_set1_ps(high), 1);
+    }
+
+    // Row i of the matrix in both 128-bit halves
+    inline __m256 broadcastRow(const Matrix4x4& m, int row)
+    {
+        return _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m.m[row]));
+    }
+
+    // Two rows of a (one per half) times b, with b's rows pre-broadcast
+    inline __m256 multiplyRowPair(__m256 rows, const __m256 b[4])
+    {
+        __m256 r = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(0, 0, 0, 0)), b[0]);
+        r = madd256(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(1, 1, 1, 1)), b[1], r);
+        r = madd256(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(2, 2, 2, 2)), b[2], r);
+        return madd256(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(3, 3, 3, 3)), b[3], r);
+    }
+
+    inline void multiplyAVX(const Matrix4x4& a, const __m256 b[4], Matrix4x4& out)
+    {
+        __m256 rows01 = _mm256_loadu_ps(a.m[0]);
+        __m256 rows23 = _mm256_loadu_ps(a.m[2]);
+        _mm256_storeu_ps(out.m[0], multiplyRowPair(rows01, b));
+        _mm256_storeu_ps(out.m[2], multiplyRowPair(rows23, b));
+    }
+#endif
+}
+
+const char* simd::backendName()
+{
+#if defined(DX3D_SIMD_AVX2)
+    return "avx2";
+#elif defined(DX3D_SIMD_SSE)
+    return "sse";
+#elif defined(DX3D_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void simd::transformPoints(const Matrix4x4& m, const Vector3* points, Vector3* out, std::size_t count)
+{
+    std::size_t i = 0;
+
+#if defined(DX3D_SIMD_AVX2)
+    const __m256 row0 = broadcastRow(m, 0);
+    const __m256 row1 = broadcastRow(m, 1);
+    const __m256 row2 = broadcastRow(m, 2);
+    const __m256 row3 = broadcastRow(m, 3);
+
+    for (; i + 2 <= count; i += 2)
+    {
+        const Vector3& p0 = points[i];
+        const Vector3& p1 = points[i + 1];
+        __m256 r = madd256(pair(p0.x, p1.x), row0, row3);
+        r = madd256(pair(p0.y, p1.y), row1, r);
+        r = madd256(pair(p0.z, p1.z), row2, r);
+
+        alignas(32) float values[8];
+        _mm256_store_ps(values, r);
+        out[i] = Vector3(values[0], values[1], values[2]);
+        out[i + 1] = Vector3(values[4], values[5], values[6]);
+    }
+#endif
+
+    const Mat4 matrix = loadMatrix(&m.m[0][0]);
+    for (; i < count; ++i)
+    {
+        storeVector3(out[i], transformPoint(points[i].x, points[i].y, points[i].z, matrix));
+    }
+}
+
+void simd::transformNormals(const Matrix4x4& m, const Vector3* vectors, Vector3* out, std::size_t count)
+{
+    const Mat4 matrix = loadMatrix(&m.m[0][0]);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        storeVector3(out[i], transformNormal(vectors[i].x, vectors[i].y, vectors[i].z, matrix));
+    }
+}
+
+void simd::multiply(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+#if defined(DX3D_SIMD_AVX2)
+        // b is loaded in full first so out may alias it
+        const __m256 rowsB[4] = { broadcastRow(b[i], 0), broadcastRow(b[i], 1), broadcastRow(b[i], 2), broadcastRow(b[i], 3) };
+        multiplyAVX(a[i], rowsB, out[i]);
+#else
+        storeMatrix(&out[i].m[0][0], simd::multiply(loadMatrix(&a[i].m[0][0]), loadMatrix(&b[i].m[0][0])));
+#endif
+    }
+}
+
+void simd::multiply(const Matrix4x4* a, const Matrix4x4& b, Matrix4x4* out, std::size_t count)
+{
+#if defined(DX3D_SIMD_AVX2)
+    const __m256 rowsB[4] = { broadcastRow(b, 0), broadcastRow(b, 1), broadcastRow(b, 2), broadcastRow(b, 3) };
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        multiplyAVX(a[i], rowsB, out[i]);
+    }
+#else
+    const Mat4 matrixB = loadMatrix(&b.m[0][0]);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        storeMatrix(&out[i].m[0][0], simd::multiply(loadMatrix(&a[i].m[0][0]), matrixB));
+    }
+#endif
+}
+
+void simd::transpose(const Matrix4x4* in, Matrix4x4* out, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Mat4 matrix = loadMatrix(&in[i].m[0][0]);
+        transposeInPlace(matrix);
+        storeMatrix(&out[i].m[0][0], matrix);
+    }
+}
+
+void simd::composeTransforms(const Vector3* positions, const Vector3* rotations, const Vector3* scales,
+    Matrix4x4* out, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        storeMatrix(&out[i].m[0][0], composeTransform(&positions[i].x, &rotations[i].x, &scales[i].x));
+    }
+}
+
+void simd::composeTransforms(const TransformArrays& in, Matrix4x4* out, std::size_t count)
+{
+    std::size_t i = 0;
+
+#if !defined(DX3D_SIMD_SCALAR)
+    const Vec4 zero = splat(0.0f);
+    const Vec4 one = splat(1.0f);
+
+    // Each Vec4 holds one matrix element for four transforms; the final
+    // transposes turn those columns back into per-transform rows
+    for (; i + 4 <= count; i += 4)
+    {
+        const Vec4 x = load(in.rotation[0] + i);
+        const Vec4 y = load(in.rotation[1] + i);
+        const Vec4 z = load(in.rotation[2] + i);
+        const Vec4 w = load(in.rotation[3] + i);
+        const Vec4 x2 = add(x, x), y2 = add(y, y), z2 = add(z, z);
+        const Vec4 xx = mul(x, x2), yy = mul(y, y2), zz = mul(z, z2);
+        const Vec4 xy = mul(x, y2), xz = mul(x, z2), yz = mul(y, z2);
+        const Vec4 wx = mul(w, x2), wy = mul(w, y2), wz = mul(w, z2);
+
+        const Vec4 scaleX = load(in.scale[0] + i);
+        const Vec4 scaleY = load(in.scale[1] + i);
+        const Vec4 scaleZ = load(in.scale[2] + i);
+
+        Mat4 row0 = { {
+            mul(scaleX, sub(one, add(yy, zz))),
+            mul(scaleX, add(xy, wz)),
+            mul(scaleX, sub(xz, wy)),
+            zero } };
+        Mat4 row1 = { {
+            mul(scaleY, sub(xy, wz)),
+            mul(scaleY, sub(one, add(xx, zz))),
+            mul(scaleY, add(yz, wx)),
+            zero } };
+        Mat4 row2 = { {
+            mul(scaleZ, add(xz, wy)),
+            mul(scaleZ, sub(yz, wx)),
+            mul(scaleZ, sub(one, add(xx, yy))),
+            zero } };
+        Mat4 row3 = { { load(in.position[0] + i), load(in.position[1] + i), load(in.position[2] + i), one } };
+
+        transposeInPlace(row0);
+        transposeInPlace(row1);
+        transposeInPlace(row2);
+        transposeInPlace(row3);
+
+        for (int k = 0; k < 4; k++)
+        {
+            float* matrix = &out[i + k].m[0][0];
+            store(matrix, row0.r[k]);
+            store(matrix + 4, row1.r[k]);
+            store(matrix + 8, row2.r[k]);
+            store(matrix + 12, row3.r[k]);
+        }
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        const float position[3] = { in.position[0][i], in.position[1][i], in.position[2][i] };
+        const float rotation[4] = { in.rotation[0][i], in.rotation[1][i], in.rotation[2][i], in.rotation[3][i] };
+        const float scale[3] = { in.scale[0][i], in.scale[1][i], in.scale[2][i] };
+        storeMatrix(&out[i].m[0][0], composeTransformQuaternion(position, rotation, scale));
+    }
+}
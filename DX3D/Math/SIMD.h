@@ -0,0 +1,346 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+// Backend selection. Define DX3D_SIMD_FORCE_SCALAR to compare against the
+// reference path. AVX2 implies SSE; it only adds wider batch kernels.
+#if !defined(DX3D_SIMD_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define DX3D_SIMD_SSE 1
+#include <immintrin.h>
+#if defined(__AVX2__)
+#define DX3D_SIMD_AVX2 1
+#endif
+#elif !defined(DX3D_SIMD_FORCE_SCALAR) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define DX3D_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#define DX3D_SIMD_SCALAR 1
+#endif
+
+namespace dx3d
+{
+    struct Vector3;
+    struct Matrix4x4;
+
+    // Portable 4-wide float math used by Math.cpp and the batch kernels.
+    // Vec4 and Mat4 are register-sized and aligned; Matrix4x4 stays the
+    // plain storage type that goes into constant buffers and components.
+    //
+    // Matrices are row-major and multiply row vectors on the left, matching
+    // the existing Matrix4x4 and HLSL conventions: v' = v * M, and A * B
+    // applies A first.
+    namespace simd
+    {
+        const char* backendName();
+
+        struct alignas(16) Vec4
+        {
+#if defined(DX3D_SIMD_SSE)
+            __m128 v;
+#elif defined(DX3D_SIMD_NEON)
+            float32x4_t v;
+#else
+            float v[4];
+#endif
+        };
+
+        struct alignas(16) Mat4
+        {
+            Vec4 r[4];
+        };
+
+#if defined(DX3D_SIMD_SSE)
+
+        inline Vec4 set(float x, float y, float z, float w) { return { _mm_setr_ps(x, y, z, w) }; }
+        inline Vec4 splat(float s) { return { _mm_set1_ps(s) }; }
+        inline Vec4 load(const float* p) { return { _mm_loadu_ps(p) }; }
+        inline void store(float* p, Vec4 a) { _mm_storeu_ps(p, a.v); }
+        inline Vec4 add(Vec4 a, Vec4 b) { return { _mm_add_ps(a.v, b.v) }; }
+        inline Vec4 sub(Vec4 a, Vec4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+        inline Vec4 mul(Vec4 a, Vec4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+#if defined(__FMA__)
+        inline Vec4 madd(Vec4 a, Vec4 b, Vec4 c) { return { _mm_fmadd_ps(a.v, b.v, c.v) }; }
+#else
+        inline Vec4 madd(Vec4 a, Vec4 b, Vec4 c) { return { _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v) }; }
+#endif
+
+        template<int Lane>
+        inline Vec4 splatLane(Vec4 a) { return { _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(Lane, Lane, Lane, Lane)) }; }
+
+        template<int Lane>
+        inline float getLane(Vec4 a) { return _mm_cvtss_f32(_mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(Lane, Lane, Lane, Lane))); }
+
+        // (a.x, a.y, a.z) x (b.x, b.y, b.z); w is 0
+        inline Vec4 cross3(Vec4 a, Vec4 b)
+        {
+            __m128 aYZX = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 bYZX = _mm_shuffle_ps(b.v, b.v, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 c = _mm_sub_ps(_mm_mul_ps(a.v, bYZX), _mm_mul_ps(aYZX, b.v));
+            return { _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)) };
+        }
+
+        inline float dot3(Vec4 a, Vec4 b)
+        {
+            __m128 m = _mm_mul_ps(a.v, b.v);
+            __m128 y = _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1));
+            __m128 z = _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2));
+            return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(m, y), z));
+        }
+
+        inline void transposeInPlace(Mat4& m)
+        {
+            _MM_TRANSPOSE4_PS(m.r[0].v, m.r[1].v, m.r[2].v, m.r[3].v);
+        }
+
+#elif defined(DX3D_SIMD_NEON)
+
+        inline Vec4 set(float x, float y, float z, float w)
+        {
+            const float values[4] = { x, y, z, w };
+            return { vld1q_f32(values) };
+        }
+        inline Vec4 splat(float s) { return { vdupq_n_f32(s) }; }
+        inline Vec4 load(const float* p) { return { vld1q_f32(p) }; }
+        inline void store(float* p, Vec4 a) { vst1q_f32(p, a.v); }
+        inline Vec4 add(Vec4 a, Vec4 b) { return { vaddq_f32(a.v, b.v) }; }
+        inline Vec4 sub(Vec4 a, Vec4 b) { return { vsubq_f32(a.v, b.v) }; }
+        inline Vec4 mul(Vec4 a, Vec4 b) { return { vmulq_f32(a.v, b.v) }; }
+        inline Vec4 madd(Vec4 a, Vec4 b, Vec4 c) { return { vmlaq_f32(c.v, a.v, b.v) }; }
+
+        template<int Lane>
+        inline Vec4 splatLane(Vec4 a) { return { vdupq_n_f32(vgetq_lane_f32(a.v, Lane)) }; }
+
+        template<int Lane>
+        inline float getLane(Vec4 a) { return vgetq_lane_f32(a.v, Lane); }
+
+        inline Vec4 cross3(Vec4 a, Vec4 b)
+        {
+            float ax = vgetq_lane_f32(a.v, 0), ay = vgetq_lane_f32(a.v, 1), az = vgetq_lane_f32(a.v, 2);
+            float bx = vgetq_lane_f32(b.v, 0), by = vgetq_lane_f32(b.v, 1), bz = vgetq_lane_f32(b.v, 2);
+            return set(ay * bz - az * by, az * bx - ax * bz, ax * by - ay * bx, 0.0f);
+        }
+
+        inline float dot3(Vec4 a, Vec4 b)
+        {
+            float32x4_t m = vmulq_f32(a.v, b.v);
+            return vgetq_lane_f32(m, 0) + vgetq_lane_f32(m, 1) + vgetq_lane_f32(m, 2);
+        }
+
+        inline void transposeInPlace(Mat4& m)
+        {
+            float32x4x2_t t01 = vtrnq_f32(m.r[0].v, m.r[1].v);
+            float32x4x2_t t23 = vtrnq_f32(m.r[2].v, m.r[3].v);
+            m.r[0].v = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+            m.r[1].v = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+            m.r[2].v = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+            m.r[3].v = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+        }
+
+#else
+
+        inline Vec4 set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+        inline Vec4 splat(float s) { return { { s, s, s, s } }; }
+        inline Vec4 load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+        inline void store(float* p, Vec4 a) { p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3]; }
+        inline Vec4 add(Vec4 a, Vec4 b) { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+        inline Vec4 sub(Vec4 a, Vec4 b) { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+        inline Vec4 mul(Vec4 a, Vec4 b) { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+        inline Vec4 madd(Vec4 a, Vec4 b, Vec4 c) { return add(mul(a, b), c); }
+
+        template<int Lane>
+        inline Vec4 splatLane(Vec4 a) { return splat(a.v[Lane]); }
+
+        template<int Lane>
+        inline float getLane(Vec4 a) { return a.v[Lane]; }
+
+        inline Vec4 cross3(Vec4 a, Vec4 b)
+        {
+            return set(a.v[1] * b.v[2] - a.v[2] * b.v[1], a.v[2] * b.v[0] - a.v[0] * b.v[2], a.v[0] * b.v[1] - a.v[1] * b.v[0], 0.0f);
+        }
+
+        inline float dot3(Vec4 a, Vec4 b) { return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2]; }
+
+        inline void transposeInPlace(Mat4& m)
+        {
+            for (int i = 0; i < 4; i++)
+                for (int j = i + 1; j < 4; j++)
+                {
+                    float t = m.r[i].v[j];
+                    m.r[i].v[j] = m.r[j].v[i];
+                    m.r[j].v[i] = t;
+                }
+        }
+
+#endif
+
+        // 16 floats, row-major, no alignment requirement
+        inline Mat4 loadMatrix(const float* p)
+        {
+            return { { load(p), load(p + 4), load(p + 8), load(p + 12) } };
+        }
+
+        inline void storeMatrix(float* p, const Mat4& m)
+        {
+            store(p, m.r[0]);
+            store(p + 4, m.r[1]);
+            store(p + 8, m.r[2]);
+            store(p + 12, m.r[3]);
+        }
+
+        inline Mat4 identity()
+        {
+            return { { set(1, 0, 0, 0), set(0, 1, 0, 0), set(0, 0, 1, 0), set(0, 0, 0, 1) } };
+        }
+
+        // v * m
+        inline Vec4 transform(Vec4 v, const Mat4& m)
+        {
+            Vec4 r = mul(splatLane<0>(v), m.r[0]);
+            r = madd(splatLane<1>(v), m.r[1], r);
+            r = madd(splatLane<2>(v), m.r[2], r);
+            return madd(splatLane<3>(v), m.r[3], r);
+        }
+
+        // (x, y, z, 1) * m without building the vector
+        inline Vec4 transformPoint(float x, float y, float z, const Mat4& m)
+        {
+            Vec4 r = madd(splat(x), m.r[0], m.r[3]);
+            r = madd(splat(y), m.r[1], r);
+            return madd(splat(z), m.r[2], r);
+        }
+
+        // (x, y, z, 0) * m
+        inline Vec4 transformNormal(float x, float y, float z, const Mat4& m)
+        {
+            Vec4 r = mul(splat(x), m.r[0]);
+            r = madd(splat(y), m.r[1], r);
+            return madd(splat(z), m.r[2], r);
+        }
+
+        inline Mat4 multiply(const Mat4& a, const Mat4& b)
+        {
+            Mat4 result;
+            for (int i = 0; i < 4; i++)
+            {
+                result.r[i] = transform(a.r[i], b);
+            }
+            return result;
+        }
+
+        inline Mat4 transpose(Mat4 m)
+        {
+            transposeInPlace(m);
+            return m;
+        }
+
+        // Scale * RotationZ * RotationY * RotationX * Translation in one pass,
+        // the Euler order used by the editor. Angles are in radians.
+        inline Mat4 composeTransform(const float position[3], const float rotation[3], const float scale[3])
+        {
+            const float sx = std::sin(rotation[0]), cx = std::cos(rotation[0]);
+            const float sy = std::sin(rotation[1]), cy = std::cos(rotation[1]);
+            const float sz = std::sin(rotation[2]), cz = std::cos(rotation[2]);
+
+            Mat4 m;
+            m.r[0] = mul(splat(scale[0]), set(cz * cy, sz * cx + cz * sy * sx, sz * sx - cz * sy * cx, 0.0f));
+            m.r[1] = mul(splat(scale[1]), set(-sz * cy, cz * cx - sz * sy * sx, cz * sx + sz * sy * cx, 0.0f));
+            m.r[2] = mul(splat(scale[2]), set(sy, -cy * sx, cy * cx, 0.0f));
+            m.r[3] = set(position[0], position[1], position[2], 1.0f);
+            return m;
+        }
+
+        // Same as composeTransform with the rotation given as a unit
+        // quaternion (x, y, z, w); no trigonometry needed
+        inline Mat4 composeTransformQuaternion(const float position[3], const float rotation[4], const float scale[3])
+        {
+            const float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+            const float xx = x * x, yy = y * y, zz = z * z;
+            const float xy = x * y, xz = x * z, yz = y * z;
+            const float wx = w * x, wy = w * y, wz = w * z;
+
+            Mat4 m;
+            m.r[0] = mul(splat(scale[0]), set(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f));
+            m.r[1] = mul(splat(scale[1]), set(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f));
+            m.r[2] = mul(splat(scale[2]), set(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f));
+            m.r[3] = set(position[0], position[1], position[2], 1.0f);
+            return m;
+        }
+
+        // General inverse via cross products of the row vectors. Returns
+        // false and leaves out untouched if the matrix is singular.
+        inline bool inverse(const Mat4& m, Mat4& out)
+        {
+            // With rows a, b, c, d and their w components x, y, z, w
+            const Vec4 a = m.r[0], b = m.r[1], c = m.r[2], d = m.r[3];
+            const float x = getLane<3>(a), y = getLane<3>(b), z = getLane<3>(c), w = getLane<3>(d);
+
+            Vec4 s = cross3(a, b);
+            Vec4 t = cross3(c, d);
+            Vec4 u = sub(mul(splat(y), a), mul(splat(x), b));
+            Vec4 v = sub(mul(splat(w), c), mul(splat(z), d));
+
+            const float det = dot3(s, v) + dot3(t, u);
+            if (std::fabs(det) < 1e-12f)
+                return false;
+
+            const Vec4 invDet = splat(1.0f / det);
+            s = mul(s, invDet);
+            t = mul(t, invDet);
+            u = mul(u, invDet);
+            v = mul(v, invDet);
+
+            // These are the columns of the inverse; w lanes are patched in
+            // before the final transpose
+            Vec4 c0 = madd(splat(y), t, cross3(b, v));
+            Vec4 c1 = sub(cross3(v, a), mul(splat(x), t));
+            Vec4 c2 = madd(splat(w), s, cross3(d, u));
+            Vec4 c3 = sub(cross3(u, c), mul(splat(z), s));
+
+            alignas(16) float col[4][4];
+            store(col[0], c0);
+            store(col[1], c1);
+            store(col[2], c2);
+            store(col[3], c3);
+            col[0][3] = -dot3(b, t);
+            col[1][3] = dot3(a, t);
+            col[2][3] = -dot3(d, s);
+            col[3][3] = dot3(c, s);
+
+            Mat4 result = { { load(col[0]), load(col[1]), load(col[2]), load(col[3]) } };
+            transposeInPlace(result);
+            out = result;
+            return true;
+        }
+
+        // Batch kernels (Math/SIMD.cpp). in and out may not overlap unless
+        // they are the same array.
+
+        // out[i] = (points[i], 1) * m
+        void transformPoints(const Matrix4x4& m, const Vector3* points, Vector3* out, std::size_t count);
+        // out[i] = (vectors[i], 0) * m
+        void transformNormals(const Matrix4x4& m, const Vector3* vectors, Vector3* out, std::size_t count);
+        // out[i] = a[i] * b[i]
+        void multiply(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out, std::size_t count);
+        // out[i] = a[i] * b, e.g. a batch of locals against one parent
+        void multiply(const Matrix4x4* a, const Matrix4x4& b, Matrix4x4* out, std::size_t count);
+        // out[i] = transpose(in[i]), e.g. when filling constant buffers
+        void transpose(const Matrix4x4* in, Matrix4x4* out, std::size_t count);
+        // out[i] = composeTransform(positions[i], rotations[i], scales[i])
+        void composeTransforms(const Vector3* positions, const Vector3* rotations, const Vector3* scales,
+            Matrix4x4* out, std::size_t count);
+
+        // Structure-of-arrays input for the wide compose kernel: one array
+        // per component, e.g. position[0] holds every x. rotation is a unit
+        // quaternion split into x, y, z, w arrays.
+        struct TransformArrays
+        {
+            const float* position[3];
+            const float* rotation[4];
+            const float* scale[3];
+        };
+
+        // Same result as composeTransformQuaternion, four transforms per
+        // iteration
+        void composeTransforms(const TransformArrays& in, Matrix4x4* out, std::size_t count);
+    }
+}
@@ -104,8 +104,8 @@ void ParticleSystem::render(DeviceContext& deviceContext, const SceneCamera& cam
 
     // Update constant buffer with camera data
     ParticleConstantBuffer cbData;
-    cbData.view = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(camera.getViewMatrix().toXMMatrix()));
-    cbData.projection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(projectionMatrix.toXMMatrix()));
+    cbData.view = Matrix4x4::Transpose(camera.getViewMatrix());
+    cbData.projection = Matrix4x4::Transpose(projectionMatrix);
     cbData.cameraRight = camera.getRight();
     cbData.cameraUp = camera.getUp();
 
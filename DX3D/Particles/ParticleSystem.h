@@ -20,11 +20,13 @@ namespace dx3d
     class ParticleSystem
     {
     public:
-        static ParticleSystem& getInstance()
-        {
-            static ParticleSystem instance;
-            return instance;
-        }
+        // Emitters of the calling thread's current World (see Scene/World.h)
+        static ParticleSystem& getInstance();
+
+        ParticleSystem() = default;
+        ~ParticleSystem() = default;
+        ParticleSystem(const ParticleSystem&) = delete;
+        ParticleSystem& operator=(const ParticleSystem&) = delete;
 
         void initialize(GraphicsEngine& graphicsEngine);
         void shutdown();
@@ -53,11 +55,6 @@ namespace dx3d
         void setBlendMode(BlendMode mode) { m_blendMode = mode; }
 
     private:
-        ParticleSystem() = default;
-        ~ParticleSystem() = default;
-        ParticleSystem(const ParticleSystem&) = delete;
-        ParticleSystem& operator=(const ParticleSystem&) = delete;
-
         void createRenderingResources(GraphicsEngine& graphicsEngine);
         void updateInstanceBuffer(DeviceContext& deviceContext, const std::vector<ParticleInstanceData>& instanceData);
 
@@ -76,12 +73,12 @@ namespace dx3d
 
         // Instance buffer for instanced rendering
         Microsoft::WRL::ComPtr<ID3D11Buffer> m_instanceBuffer;
-        ui32 m_instanceBufferCapacity;
+        ui32 m_instanceBufferCapacity = 0;
 
         // Texture for particles (future enhancement)
         // std::shared_ptr<Texture2D> m_particleTexture;
 
-        BlendMode m_blendMode;
-        bool m_initialized;
+        BlendMode m_blendMode = BlendMode::Alpha;
+        bool m_initialized = false;
     };
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include <../Physics/HeightMap.h>
+#include <../Assets/tiny_obj_loader.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+using namespace dx3d;
+
+namespace
+{
+    // Sorted distinct coordinates, merging values closer than epsilon
+    std::vector<float> uniqueCoordinates(std::vector<float> values, float epsilon)
+    {
+        std::sort(values.begin(), values.end());
+
+        std::vector<float> unique;
+        for (float value : values)
+        {
+            if (unique.empty() || value - unique.back() > epsilon)
+                unique.push_back(value);
+        }
+        return unique;
+    }
+
+    // Index of the coordinate matching value, or -1 when the spacing is not
+    // regular enough to contain it
+    i32 gridIndex(float value, float first, float cellSize, ui32 count)
+    {
+        float position = (value - first) / cellSize;
+        float index = std::round(position);
+        if (std::fabs(position - index) > 0.01f || index < 0.0f || index >= static_cast<float>(count))
+            return -1;
+
+        return static_cast<i32>(index);
+    }
+}
+
+std::shared_ptr<const HeightMap> HeightMap::LoadFromGridOBJ(const std::string& path)
+{
+    tinyobj::ObjReaderConfig readerConfig;
+    readerConfig.triangulate = false;
+    readerConfig.vertex_color = false;
+
+    tinyobj::ObjReader objReader;
+    if (!objReader.ParseFromFile(path, readerConfig))
+    {
+        printf("Failed to read terrain OBJ %s\n", path.c_str());
+        return nullptr;
+    }
+
+    const std::vector<float>& vertices = objReader.GetAttrib().vertices;
+    size_t vertexCount = vertices.size() / 3;
+    if (vertexCount < 4)
+        return nullptr;
+
+    std::vector<float> xs(vertexCount);
+    std::vector<float> zs(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        xs[i] = vertices[3 * i + 0];
+        zs[i] = vertices[3 * i + 2];
+    }
+
+    std::vector<float> columnsX = uniqueCoordinates(xs, 1e-4f);
+    std::vector<float> rowsZ = uniqueCoordinates(zs, 1e-4f);
+    if (columnsX.size() < 2 || rowsZ.size() < 2)
+        return nullptr;
+
+    auto heightMap = std::make_shared<HeightMap>();
+    heightMap->columns = static_cast<ui32>(columnsX.size());
+    heightMap->rows = static_cast<ui32>(rowsZ.size());
+    heightMap->cellSizeX = (columnsX.back() - columnsX.front()) / (heightMap->columns - 1);
+    heightMap->cellSizeZ = (rowsZ.back() - rowsZ.front()) / (heightMap->rows - 1);
+    heightMap->origin = Vector3(columnsX.front(), 0.0f, rowsZ.front());
+    heightMap->heights.assign(static_cast<size_t>(heightMap->columns) * heightMap->rows, NAN);
+
+    // Every vertex must land on a grid point and every grid point must get
+    // a height, otherwise this is not a heightfield
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        i32 column = gridIndex(xs[i], columnsX.front(), heightMap->cellSizeX, heightMap->columns);
+        i32 row = gridIndex(zs[i], rowsZ.front(), heightMap->cellSizeZ, heightMap->rows);
+        if (column < 0 || row < 0)
+        {
+            printf("Terrain OBJ %s is not a regular grid\n", path.c_str());
+            return nullptr;
+        }
+
+        float& height = heightMap->heights[static_cast<size_t>(row) * heightMap->columns + column];
+        height = std::isnan(height) ? vertices[3 * i + 1] : std::max(height, vertices[3 * i + 1]);
+    }
+
+    if (std::any_of(heightMap->heights.begin(), heightMap->heights.end(), [](float height) { return std::isnan(height); }))
+    {
+        printf("Terrain OBJ %s has holes in its grid\n", path.c_str());
+        return nullptr;
+    }
+
+    return heightMap;
+}
+
+std::shared_ptr<const HeightMap> HeightMap::LoadFromRaw16(
+    const std::string& path,
+    ui32 columns,
+    ui32 rows,
+    float cellSize,
+    float heightScale)
+{
+    if (columns < 2 || rows < 2)
+        return nullptr;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        printf("Failed to open heightmap %s\n", path.c_str());
+        return nullptr;
+    }
+
+    size_t sampleCount = static_cast<size_t>(columns) * rows;
+    std::vector<unsigned char> bytes(sampleCount * 2);
+    if (!file.read(reinterpret_cast<char*>(bytes.data()), bytes.size()))
+    {
+        printf("Heightmap %s is smaller than %ux%u\n", path.c_str(), columns, rows);
+        return nullptr;
+    }
+
+    auto heightMap = std::make_shared<HeightMap>();
+    heightMap->columns = columns;
+    heightMap->rows = rows;
+    heightMap->cellSizeX = cellSize;
+    heightMap->cellSizeZ = cellSize;
+    heightMap->origin = Vector3(-0.5f * cellSize * (columns - 1), 0.0f, -0.5f * cellSize * (rows - 1));
+    heightMap->heights.resize(sampleCount);
+
+    for (size_t i = 0; i < sampleCount; ++i)
+    {
+        ui32 sample = bytes[2 * i] | (bytes[2 * i + 1] << 8);
+        heightMap->heights[i] = sample / 65535.0f * heightScale;
+    }
+
+    return heightMap;
+}
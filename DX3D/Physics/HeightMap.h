@@ -0,0 +1,37 @@
+#pragma once
+#include <../Math/Math.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    // Regular grid of terrain heights. Samples are row-major, columns run
+    // along +X and rows along +Z, starting at origin.
+    struct HeightMap
+    {
+        ui32 columns = 0;
+        ui32 rows = 0;
+        float cellSizeX = 1.0f;
+        float cellSizeZ = 1.0f;
+        // Position of sample (0, 0) relative to the terrain entity
+        Vector3 origin;
+        std::vector<float> heights;
+
+        float getHeight(ui32 column, ui32 row) const { return heights[row * columns + column]; }
+
+        // Reads the vertex positions of an OBJ whose vertices form a regular
+        // XZ grid, e.g. a subdivided plane. Returns null for any other mesh.
+        static std::shared_ptr<const HeightMap> LoadFromGridOBJ(const std::string& path);
+
+        // Reads a headerless little-endian 16-bit heightmap, centered on the
+        // entity, with 65535 mapping to heightScale
+        static std::shared_ptr<const HeightMap> LoadFromRaw16(
+            const std::string& path,
+            ui32 columns,
+            ui32 rows,
+            float cellSize,
+            float heightScale
+        );
+    };
+}
@@ -0,0 +1,365 @@
+#include <../Physics/PhysicsRecorder.h>
+#include <../Physics/HeightMap.h>
+#include <algorithm>
+#include <fstream>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr std::uint32_t NO_MESH = 0xFFFFFFFFu;
+}
+
+PhysicsRecorder::PhysicsRecorder()
+{
+    setBudget(DEFAULT_BUDGET);
+}
+
+size_t PhysicsRecorder::getSize() const
+{
+    size_t size = 0;
+    for (const auto& segment : m_segments)
+    {
+        size += segment.size();
+    }
+    return size;
+}
+
+void PhysicsRecorder::clear()
+{
+    for (auto& segment : m_segments)
+    {
+        segment.clear();
+    }
+    m_current = 0;
+    m_used = 1;
+    m_keyframeBytes = 0;
+    m_meshIds.clear();
+}
+
+void PhysicsRecorder::beginSegment()
+{
+    if (!m_segments[m_current].empty())
+    {
+        m_current = (m_current + 1) % SEGMENT_COUNT;
+        m_used = std::min(m_used + 1, SEGMENT_COUNT);
+    }
+
+    // Keeps its capacity from the last time round the ring
+    m_segments[m_current].clear();
+    m_segments[m_current].reserve(m_segmentBytes);
+    m_keyframeBytes = 0;
+    m_meshIds.clear();
+}
+
+void PhysicsRecorder::keyframeBegin(bool fromEmptyWorld)
+{
+    write(PhysicsRecord::KeyframeBegin);
+    write(static_cast<std::uint8_t>(fromEmptyWorld));
+}
+
+void PhysicsRecorder::keyframeEnd()
+{
+    write(PhysicsRecord::KeyframeEnd);
+    m_keyframeBytes = m_segments[m_current].size();
+}
+
+void PhysicsRecorder::bodyState(EntityID entity, const Vector3& linearVelocity, const Vector3& angularVelocity, bool sleeping)
+{
+    write(PhysicsRecord::BodyState);
+    write(entity);
+    write(linearVelocity);
+    write(angularVelocity);
+    write(static_cast<std::uint8_t>(sleeping));
+}
+
+void PhysicsRecorder::body(PhysicsRecord type, EntityID entity, const PhysicsComponent& component,
+    const Vector3& position, const Quaternion& rotation)
+{
+    // Goes ahead of the record that refers to it
+    std::uint32_t meshId = component.collisionMesh ? writeMesh(*component.collisionMesh) : NO_MESH;
+
+    write(type);
+    write(entity);
+    write(component.bodyType);
+    write(component.shapeType);
+    write(component.boxHalfExtents);
+    write(component.sphereRadius);
+    write(component.cylinderRadius);
+    write(component.cylinderHeight);
+    write(component.capsuleRadius);
+    write(component.capsuleHeight);
+    write(meshId);
+    write(component.meshScale);
+    write(component.mass);
+    write(component.restitution);
+    write(component.friction);
+    write(static_cast<std::uint8_t>(component.isTrigger));
+    write(component.eventTags);
+    write(position);
+    write(rotation);
+}
+
+void PhysicsRecorder::remove(PhysicsRecord type, EntityID entity)
+{
+    write(type);
+    write(entity);
+}
+
+void PhysicsRecorder::vector(PhysicsRecord type, EntityID entity, const Vector3& value)
+{
+    write(type);
+    write(entity);
+    write(value);
+}
+
+void PhysicsRecorder::transform(EntityID entity, const Vector3& position, const Quaternion& rotation)
+{
+    write(PhysicsRecord::SetTransform);
+    write(entity);
+    write(position);
+    write(rotation);
+}
+
+void PhysicsRecorder::material(EntityID entity, const PhysicsComponent& component)
+{
+    write(PhysicsRecord::SetMaterial);
+    write(entity);
+    write(component.mass);
+    write(component.restitution);
+    write(component.friction);
+}
+
+void PhysicsRecorder::terrain(EntityID entity, const TerrainComponent& terrain, const Vector3& position)
+{
+    const HeightMap& heightMap = *terrain.heightMap;
+
+    write(PhysicsRecord::AddTerrain);
+    write(entity);
+    write(position);
+    write(terrain.tileCells);
+    write(terrain.streamRadius);
+    write(terrain.restitution);
+    write(terrain.friction);
+    write(terrain.eventTags);
+    write(heightMap.columns);
+    write(heightMap.rows);
+    write(heightMap.cellSizeX);
+    write(heightMap.cellSizeZ);
+    write(heightMap.origin);
+    writeArray(heightMap.heights);
+}
+
+void PhysicsRecorder::steps(ui32 count, float timeStep, std::uint64_t checksum)
+{
+    write(PhysicsRecord::Steps);
+    write(count);
+    write(timeStep);
+    write(checksum);
+}
+
+bool PhysicsRecorder::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    file.write(reinterpret_cast<const char*>(&MAGIC), sizeof(MAGIC));
+    file.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+
+    for (ui32 i = 0; i < m_used; ++i)
+    {
+        const auto& segment = m_segments[(m_current + SEGMENT_COUNT - m_used + 1 + i) % SEGMENT_COUNT];
+        file.write(reinterpret_cast<const char*>(segment.data()), static_cast<std::streamsize>(segment.size()));
+    }
+    return file.good();
+}
+
+void PhysicsRecorder::writeString(const std::string& value)
+{
+    std::vector<char> characters(value.begin(), value.end());
+    writeArray(characters);
+}
+
+std::uint32_t PhysicsRecorder::writeMesh(const CollisionMesh& mesh)
+{
+    // Meshes without a source cannot be told apart, so they are written each time
+    if (!mesh.sourcePath.empty())
+    {
+        auto it = m_meshIds.find(mesh.sourcePath);
+        if (it != m_meshIds.end())
+            return it->second;
+    }
+
+    std::uint32_t id = static_cast<std::uint32_t>(m_meshIds.size());
+    m_meshIds[mesh.sourcePath.empty() ? std::to_string(id) : mesh.sourcePath] = id;
+
+    write(PhysicsRecord::Mesh);
+    write(id);
+    writeString(mesh.sourcePath);
+    writeArray(mesh.positions);
+    writeArray(mesh.indices);
+    write(mesh.boundsMin);
+    write(mesh.boundsMax);
+    return id;
+}
+
+bool PhysicsLogReader::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+
+    m_data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(m_data.data()), static_cast<std::streamsize>(m_data.size()));
+    m_offset = 0;
+    m_damaged = false;
+    m_meshes.clear();
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    return read(magic) && read(version) &&
+        magic == PhysicsRecorder::MAGIC && version == PhysicsRecorder::VERSION;
+}
+
+bool PhysicsLogReader::next(PhysicsLogEntry& entry)
+{
+    while (m_offset < m_data.size())
+    {
+        PhysicsRecord type{};
+        if (!read(type))
+        {
+            m_damaged = true;
+            return false;
+        }
+
+        bool ok = true;
+        if (type == PhysicsRecord::Mesh)
+        {
+            ok = readMesh();
+            if (ok)
+                continue;
+        }
+
+        entry.type = type;
+        switch (type)
+        {
+        case PhysicsRecord::KeyframeBegin:
+        {
+            // Mesh ids start over with every segment
+            m_meshes.clear();
+            std::uint8_t fromEmptyWorld = 0;
+            ok = read(fromEmptyWorld);
+            entry.fromEmptyWorld = fromEmptyWorld != 0;
+            break;
+        }
+
+        case PhysicsRecord::KeyframeEnd:
+            break;
+
+        case PhysicsRecord::BodyState:
+        {
+            std::uint8_t sleeping = 0;
+            ok = read(entry.entity) && read(entry.vector) && read(entry.angularVelocity) && read(sleeping);
+            entry.sleeping = sleeping != 0;
+            break;
+        }
+
+        case PhysicsRecord::AddBody:
+        case PhysicsRecord::UpdateBody:
+        {
+            PhysicsComponent& component = entry.component;
+            std::uint32_t meshId = NO_MESH;
+            std::uint8_t isTrigger = 0;
+            ok = read(entry.entity) && read(component.bodyType) && read(component.shapeType) &&
+                read(component.boxHalfExtents) && read(component.sphereRadius) &&
+                read(component.cylinderRadius) && read(component.cylinderHeight) &&
+                read(component.capsuleRadius) && read(component.capsuleHeight) &&
+                read(meshId) && read(component.meshScale) &&
+                read(component.mass) && read(component.restitution) && read(component.friction) &&
+                read(isTrigger) && read(component.eventTags) &&
+                read(entry.vector) && read(entry.rotation);
+            component.isTrigger = isTrigger != 0;
+
+            auto mesh = m_meshes.find(meshId);
+            component.collisionMesh = mesh != m_meshes.end() ? mesh->second : nullptr;
+            break;
+        }
+
+        case PhysicsRecord::RemoveBody:
+        case PhysicsRecord::RemoveTerrain:
+            ok = read(entry.entity);
+            break;
+
+        case PhysicsRecord::ApplyForce:
+        case PhysicsRecord::ApplyImpulse:
+        case PhysicsRecord::SetLinearVelocity:
+            ok = read(entry.entity) && read(entry.vector);
+            break;
+
+        case PhysicsRecord::SetTransform:
+            ok = read(entry.entity) && read(entry.vector) && read(entry.rotation);
+            break;
+
+        case PhysicsRecord::SetMaterial:
+            ok = read(entry.entity) && read(entry.component.mass) &&
+                read(entry.component.restitution) && read(entry.component.friction);
+            break;
+
+        case PhysicsRecord::AddTerrain:
+        {
+            TerrainComponent& terrain = entry.terrain;
+            auto heightMap = std::make_shared<HeightMap>();
+            ok = read(entry.entity) && read(entry.vector) &&
+                read(terrain.tileCells) && read(terrain.streamRadius) &&
+                read(terrain.restitution) && read(terrain.friction) && read(terrain.eventTags) &&
+                read(heightMap->columns) && read(heightMap->rows) &&
+                read(heightMap->cellSizeX) && read(heightMap->cellSizeZ) && read(heightMap->origin) &&
+                readArray(heightMap->heights) &&
+                heightMap->heights.size() == static_cast<size_t>(heightMap->columns) * heightMap->rows;
+            terrain.heightMap = heightMap;
+            break;
+        }
+
+        case PhysicsRecord::Steps:
+            ok = read(entry.stepCount) && read(entry.timeStep) && read(entry.checksum);
+            break;
+
+        default:
+            ok = false;
+            break;
+        }
+
+        if (!ok)
+        {
+            m_damaged = true;
+            return false;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+bool PhysicsLogReader::readString(std::string& value)
+{
+    std::vector<char> characters;
+    if (!readArray(characters))
+        return false;
+
+    value.assign(characters.begin(), characters.end());
+    return true;
+}
+
+bool PhysicsLogReader::readMesh()
+{
+    auto mesh = std::make_shared<CollisionMesh>();
+    std::uint32_t id = 0;
+    if (!read(id) || !readString(mesh->sourcePath) || !readArray(mesh->positions) || !readArray(mesh->indices) ||
+        !read(mesh->boundsMin) || !read(mesh->boundsMax))
+        return false;
+
+    m_meshes[id] = mesh;
+    return true;
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include <../ECS/Entity.h>
+#include <../ECS/Components/PhysicsComponent.h>
+#include <../ECS/Components/TerrainComponent.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace dx3d
+{
+    enum class PhysicsRecord : std::uint8_t
+    {
+        KeyframeBegin,
+        KeyframeEnd,
+        BodyState,
+        Mesh,
+        AddBody,
+        RemoveBody,
+        UpdateBody,
+        ApplyForce,
+        ApplyImpulse,
+        SetLinearVelocity,
+        SetTransform,
+        SetMaterial,
+        AddTerrain,
+        RemoveTerrain,
+        Steps
+    };
+
+    // Binary log of everything fed into a physics world: the commands that
+    // change it and the fixed steps between them. It is kept as a ring of
+    // segments that each open with a keyframe re-creating the world as it
+    // was, so the oldest segment can be dropped and what is left still
+    // replays from its start. Only the thread that owns the world writes.
+    class PhysicsRecorder
+    {
+    public:
+        static constexpr std::uint32_t MAGIC = 0x52505844; // "DXPR"
+        static constexpr std::uint32_t VERSION = 1;
+        static constexpr size_t DEFAULT_BUDGET = 32u * 1024u * 1024u;
+
+        PhysicsRecorder();
+
+        // Bytes of records the ring keeps, not counting keyframes, so a big
+        // world does not turn every segment into a keyframe. Takes effect
+        // with the next segment.
+        void setBudget(size_t bytes) { m_segmentBytes = bytes / SEGMENT_COUNT; }
+        size_t getSize() const;
+        void clear();
+
+        bool isSegmentFull() const { return m_segments[m_current].size() - m_keyframeBytes >= m_segmentBytes; }
+        // Starts a segment, dropping the oldest if the ring is full. The
+        // caller writes the keyframe next.
+        void beginSegment();
+
+        // A keyframe written into an empty world replays exactly; later
+        // ones lose rp3d's contact caches and only replay closely
+        void keyframeBegin(bool fromEmptyWorld);
+        void keyframeEnd();
+        void bodyState(EntityID entity, const Vector3& linearVelocity, const Vector3& angularVelocity, bool sleeping);
+
+        // AddBody or UpdateBody
+        void body(PhysicsRecord type, EntityID entity, const PhysicsComponent& component,
+            const Vector3& position, const Quaternion& rotation);
+        // RemoveBody or RemoveTerrain
+        void remove(PhysicsRecord type, EntityID entity);
+        // ApplyForce, ApplyImpulse or SetLinearVelocity
+        void vector(PhysicsRecord type, EntityID entity, const Vector3& value);
+        void transform(EntityID entity, const Vector3& position, const Quaternion& rotation);
+        void material(EntityID entity, const PhysicsComponent& component);
+        void terrain(EntityID entity, const TerrainComponent& terrain, const Vector3& position);
+        // Steps run back to back, each of timeStep, and a checksum of the
+        // dynamic bodies after them
+        void steps(ui32 count, float timeStep, std::uint64_t checksum);
+
+        // Header plus every segment from the oldest
+        bool save(const std::string& path) const;
+
+    private:
+        template<typename T>
+        void write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only plain data goes into the log");
+            std::vector<std::uint8_t>& segment = m_segments[m_current];
+            size_t offset = segment.size();
+            segment.resize(offset + sizeof(T));
+            std::memcpy(segment.data() + offset, &value, sizeof(T));
+        }
+
+        template<typename T>
+        void writeArray(const std::vector<T>& values)
+        {
+            write(static_cast<std::uint32_t>(values.size()));
+            std::vector<std::uint8_t>& segment = m_segments[m_current];
+            size_t offset = segment.size();
+            segment.resize(offset + values.size() * sizeof(T));
+            if (!values.empty())
+                std::memcpy(segment.data() + offset, values.data(), values.size() * sizeof(T));
+        }
+
+        void writeString(const std::string& value);
+        // Id of the mesh within the current segment, writing it on first use
+        std::uint32_t writeMesh(const CollisionMesh& mesh);
+
+    private:
+        static constexpr ui32 SEGMENT_COUNT = 8;
+
+        std::vector<std::uint8_t> m_segments[SEGMENT_COUNT];
+        ui32 m_current = 0;
+        ui32 m_used = 1;
+        size_t m_segmentBytes = 0;
+        // Size of the current segment's keyframe
+        size_t m_keyframeBytes = 0;
+
+        // Per segment, so every segment stands on its own
+        std::unordered_map<std::string, std::uint32_t> m_meshIds;
+    };
+
+    // One decoded record of a log. Only the fields of its type are set.
+    struct PhysicsLogEntry
+    {
+        PhysicsRecord type = PhysicsRecord::Steps;
+        EntityID entity = INVALID_ENTITY;
+        PhysicsComponent component;
+        TerrainComponent terrain;
+        Vector3 vector;
+        Quaternion rotation;
+        Vector3 angularVelocity;
+        bool sleeping = false;
+        bool fromEmptyWorld = false;
+        ui32 stepCount = 0;
+        float timeStep = 0.0f;
+        std::uint64_t checksum = 0;
+    };
+
+    // Reads a log written by PhysicsRecorder::save. Mesh records are
+    // resolved into the entries that use them.
+    class PhysicsLogReader
+    {
+    public:
+        bool load(const std::string& path);
+        // False at the end of the log or on a damaged record
+        bool next(PhysicsLogEntry& entry);
+        bool isDamaged() const { return m_damaged; }
+
+    private:
+        template<typename T>
+        bool read(T& value)
+        {
+            if (m_offset + sizeof(T) > m_data.size())
+                return false;
+            std::memcpy(&value, m_data.data() + m_offset, sizeof(T));
+            m_offset += sizeof(T);
+            return true;
+        }
+
+        template<typename T>
+        bool readArray(std::vector<T>& values)
+        {
+            std::uint32_t count = 0;
+            if (!read(count) || m_offset + static_cast<size_t>(count) * sizeof(T) > m_data.size())
+                return false;
+            values.resize(count);
+            if (count > 0)
+                std::memcpy(values.data(), m_data.data() + m_offset, count * sizeof(T));
+            m_offset += count * sizeof(T);
+            return true;
+        }
+
+        bool readString(std::string& value);
+        bool readMesh();
+
+    private:
+        std::vector<std::uint8_t> m_data;
+        size_t m_offset = 0;
+        bool m_damaged = false;
+        std::unordered_map<std::uint32_t, std::shared_ptr<const CollisionMesh>> m_meshes;
+    };
+}
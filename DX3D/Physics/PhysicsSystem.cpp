@@ -2,17 +2,176 @@
 #include <../ECS/ComponentManager.h>
 #include <../ECS/Components/TransformComponent.h>
 #include <../ECS/Components/PhysicsComponent.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 
 using namespace dx3d;
 
+namespace
+{
+    // Bodies carry their entity as user data, colliders their event tags
+    void* toUserData(EntityID entity)
+    {
+        return reinterpret_cast<void*>(static_cast<uintptr_t>(entity));
+    }
+
+    EntityID toEntity(const rp3d::Body* body)
+    {
+        return static_cast<EntityID>(reinterpret_cast<uintptr_t>(body->getUserData()));
+    }
+
+    ui32 toEventTags(const rp3d::Collider* collider)
+    {
+        return static_cast<ui32>(reinterpret_cast<uintptr_t>(collider->getUserData()));
+    }
+
+    float inverseMass(const rp3d::RigidBody* body)
+    {
+        return body->getType() == rp3d::BodyType::DYNAMIC && body->getMass() > 0.0f ? 1.0f / body->getMass() : 0.0f;
+    }
+
+    rp3d::Vector3 pointVelocity(const rp3d::RigidBody* body, const rp3d::Vector3& point)
+    {
+        rp3d::Vector3 centerOfMass = body->getTransform() * body->getLocalCenterOfMass();
+        return body->getLinearVelocity() + body->getAngularVelocity().cross(point - centerOfMass);
+    }
+
+    // Copies rp3d's contact and trigger reports into a flat event list.
+    // Pairs outside the tag filter are dropped before their points are read.
+    class EventRecorder : public rp3d::EventListener
+    {
+    public:
+        EventRecorder(std::vector<CollisionEvent>& events, const std::atomic<ui32>& filter) :
+            m_events(events), m_filter(filter)
+        {
+        }
+
+        void onContact(const rp3d::CollisionCallback::CallbackData& data) override
+        {
+            ui32 filter = m_filter.load(std::memory_order_relaxed);
+            ui32 pairCount = data.getNbContactPairs();
+            for (ui32 i = 0; i < pairCount; ++i)
+            {
+                rp3d::CollisionCallback::ContactPair pair = data.getContactPair(i);
+                if (((toEventTags(pair.getCollider1()) | toEventTags(pair.getCollider2())) & filter) == 0)
+                    continue;
+
+                CollisionEvent event;
+                // Same order as rp3d's contact events
+                event.type = static_cast<CollisionEvent::Type>(pair.getEventType());
+                event.entityA = toEntity(pair.getBody1());
+                event.entityB = toEntity(pair.getBody2());
+                event.impulse = 0.0f;
+                event.point = Vector3(0.0f, 0.0f, 0.0f);
+                event.normal = Vector3(0.0f, 0.0f, 0.0f);
+
+                ui32 pointCount = pair.getNbContactPoints();
+                if (pointCount > 0)
+                {
+                    const rp3d::Transform toWorld = pair.getCollider1()->getLocalToWorldTransform();
+                    rp3d::Vector3 point(0.0f, 0.0f, 0.0f);
+                    rp3d::Vector3 normal(0.0f, 0.0f, 0.0f);
+                    for (ui32 j = 0; j < pointCount; ++j)
+                    {
+                        rp3d::CollisionCallback::ContactPoint contactPoint = pair.getContactPoint(j);
+                        point += toWorld * contactPoint.getLocalPointOnCollider1();
+                        normal += contactPoint.getWorldNormal();
+                    }
+                    point /= static_cast<rp3d::decimal>(pointCount);
+                    if (normal.lengthSquare() > 0.0f)
+                        normal.normalize();
+
+                    auto* bodyA = static_cast<const rp3d::RigidBody*>(pair.getBody1());
+                    auto* bodyB = static_cast<const rp3d::RigidBody*>(pair.getBody2());
+                    float closingSpeed = (pointVelocity(bodyA, point) - pointVelocity(bodyB, point)).dot(normal);
+                    float inverseMassSum = inverseMass(bodyA) + inverseMass(bodyB);
+                    if (closingSpeed > 0.0f && inverseMassSum > 0.0f)
+                        event.impulse = closingSpeed / inverseMassSum;
+
+                    event.point = Vector3(point.x, point.y, point.z);
+                    event.normal = Vector3(normal.x, normal.y, normal.z);
+                }
+
+                m_events.push_back(event);
+            }
+        }
+
+        void onTrigger(const rp3d::OverlapCallback::CallbackData& data) override
+        {
+            ui32 filter = m_filter.load(std::memory_order_relaxed);
+            ui32 pairCount = data.getNbOverlappingPairs();
+            for (ui32 i = 0; i < pairCount; ++i)
+            {
+                rp3d::OverlapCallback::OverlapPair pair = data.getOverlappingPair(i);
+                if (((toEventTags(pair.getCollider1()) | toEventTags(pair.getCollider2())) & filter) == 0)
+                    continue;
+
+                CollisionEvent event;
+                event.type = static_cast<CollisionEvent::Type>(
+                    static_cast<int>(CollisionEvent::Type::TriggerEnter) + static_cast<int>(pair.getEventType()));
+                event.entityA = toEntity(pair.getBody1());
+                event.entityB = toEntity(pair.getBody2());
+                event.impulse = 0.0f;
+                event.point = Vector3(0.0f, 0.0f, 0.0f);
+                event.normal = Vector3(0.0f, 0.0f, 0.0f);
+                m_events.push_back(event);
+            }
+        }
+
+    private:
+        std::vector<CollisionEvent>& m_events;
+        const std::atomic<ui32>& m_filter;
+    };
+
+    class ClosestHitCallback : public rp3d::RaycastCallback
+    {
+    public:
+        rp3d::decimal notifyRaycastHit(const rp3d::RaycastInfo& info) override
+        {
+            // Returning the fraction clips the ray, so later hits can only be closer
+            hitFraction = info.hitFraction;
+            entity = toEntity(info.body);
+            point = info.worldPoint;
+            normal = info.worldNormal;
+            return info.hitFraction;
+        }
+
+        EntityID entity = INVALID_ENTITY;
+        rp3d::decimal hitFraction = 1.0f;
+        rp3d::Vector3 point;
+        rp3d::Vector3 normal;
+    };
+}
+
+PhysicsSystem::PhysicsSystem(ComponentManager& componentManager, rp3d::MemoryAllocator* allocator) :
+    m_componentManager(componentManager),
+    m_physicsCommon(allocator)
+{
+}
+
+PhysicsSystem::~PhysicsSystem()
+{
+    shutdown();
+}
+
 void PhysicsSystem::initialize()
 {
     if (m_initialized)
         return;
 
-    // Create physics world
+    if (!createWorld())
+        return;
+
+    m_initialized = true;
+    printf("PhysicsSystem initialized successfully\n");
+}
+
+bool PhysicsSystem::createWorld()
+{
     rp3d::PhysicsWorld::WorldSettings settings;
     settings.defaultVelocitySolverNbIterations = 6;
     settings.defaultPositionSolverNbIterations = 3;
@@ -24,11 +183,14 @@ void PhysicsSystem::initialize()
     if (!m_physicsWorld)
     {
         printf("Failed to create ReactPhysics3D world\n");
-        return;
+        return false;
     }
 
-    m_initialized = true;
-    printf("PhysicsSystem initialized successfully\n");
+    if (!m_eventListener)
+        m_eventListener = std::make_unique<EventRecorder>(m_collisionEvents, m_eventFilter);
+    m_physicsWorld->setEventListener(m_eventListener.get());
+    m_worldUsed = false;
+    return true;
 }
 
 void PhysicsSystem::shutdown()
@@ -36,273 +198,1605 @@ void PhysicsSystem::shutdown()
     if (!m_initialized)
         return;
 
+    stopThread();
+
+    while (!m_terrains.empty())
+    {
+        destroyTerrain(m_terrains.back().entity);
+    }
+
     if (m_physicsWorld)
     {
         m_physicsCommon.destroyPhysicsWorld(m_physicsWorld);
         m_physicsWorld = nullptr;
     }
+    m_bodies.clear();
+    m_bodyIndex.clear();
+    m_bodyComponents.clear();
+    m_pendingTeleports.clear();
+    for (Snapshot& snapshot : m_snapshots)
+    {
+        snapshot.bodies.clear();
+        snapshot.events.clear();
+    }
+    m_eventListener.reset();
+    m_collisionEvents.clear();
+    m_eventBatches.clear();
+    m_batchedEventCount = 0;
+    m_eventsFresh = false;
+    m_recorder.clear();
+    m_recording = false;
+
+    // No collider is left to use the cached shapes once the world is gone
+    for (auto& [key, cached] : m_shapeCache)
+    {
+        destroyShape(key, cached.shape);
+    }
+    m_shapeCache.clear();
+    m_shapeKeys.clear();
+    m_meshCache.clear();
 
     m_initialized = false;
     printf("PhysicsSystem shutdown complete\n");
 }
 
-void PhysicsSystem::addPhysicsComponent(EntityID entity, const PhysicsComponent& component)
+void PhysicsSystem::setThreaded(bool threaded)
 {
-    if (!m_initialized)
+    if (!m_initialized || threaded == isThreaded())
+        return;
+
+    if (!threaded)
     {
-        printf("PhysicsSystem not initialized\n");
+        stopThread();
         return;
     }
 
-    auto& componentManager = ComponentManager::getInstance();
-
-    // Add the component
-    PhysicsComponent physicsComp = component;
-    componentManager.addComponent(entity, physicsComp);
-
-    // Initialize the physics body
-    initializePhysicsBody(entity, physicsComp);
-
-    // Update the component with initialized physics objects
-    componentManager.addComponent(entity, physicsComp);
+    m_stopRequested = false;
+    m_thread = std::thread([this]() { threadMain(); });
 }
 
-void PhysicsSystem::removePhysicsComponent(EntityID entity)
+void PhysicsSystem::stopThread()
 {
-    auto& componentManager = ComponentManager::getInstance();
-    auto* physicsComp = componentManager.getComponent<PhysicsComponent>(entity);
+    if (!m_thread.joinable())
+        return;
 
-    if (physicsComp && physicsComp->rigidBody)
     {
-        m_physicsWorld->destroyRigidBody(physicsComp->rigidBody);
-        physicsComp->rigidBody = nullptr;
-        physicsComp->collider = nullptr;
+        std::lock_guard<std::mutex> lock(m_commandMutex);
+        m_stopRequested = true;
     }
+    m_commandSignal.notify_one();
+    m_thread.join();
 
-    componentManager.removeComponent<PhysicsComponent>(entity);
-}
-
-void PhysicsSystem::updatePhysicsComponent(EntityID entity, const PhysicsComponent& component)
-{
-    removePhysicsComponent(entity);
-    addPhysicsComponent(entity, component);
-}
-
-rp3d::CollisionShape* PhysicsSystem::createCollisionShape(CollisionShapeType type, const PhysicsComponent& component)
-{
-    switch (type)
-    {
-    case CollisionShapeType::Box:
+    // The world is ours again: show what the thread last published and run
+    // whatever it did not get to, commands first as the thread would
+    if (acquireSnapshot())
     {
-        rp3d::Vector3 halfExtents = toReactVector(component.boxHalfExtents);
-        return m_physicsCommon.createBoxShape(halfExtents);
+        m_timeSinceSnapshot = 0.0f;
+        m_eventsFresh = true;
+        applySnapshot(m_snapshots[m_readSnapshot], m_interpolationEnabled ? m_interpolationAlpha : 1.0f, true);
     }
 
-    case CollisionShapeType::Sphere:
+    for (const Command& command : m_pendingCommands)
     {
-        return m_physicsCommon.createSphereShape(component.sphereRadius);
+        executeCommand(command);
     }
+    m_pendingCommands.clear();
+    m_accumulator += m_pendingTime;
+    m_pendingTime = 0.0f;
 
-    case CollisionShapeType::Cylinder:
+    // Frame steps asked for just before, taken the way step() takes them
+    if (m_pendingSteps > 0)
     {
-        return m_physicsCommon.createCapsuleShape(component.cylinderRadius, component.cylinderHeight);
+        runSteps(m_pendingSteps);
+        m_pendingSteps = 0;
+        buildSnapshot(m_snapshots[m_readSnapshot], 1.0f);
+        m_consumedSequence.store(m_sequence);
+        m_timeSinceSnapshot = 0.0f;
+        m_eventsFresh = true;
+        applySnapshot(m_snapshots[m_readSnapshot], 1.0f, true);
     }
+}
 
-    case CollisionShapeType::Capsule:
+void PhysicsSystem::submit(const Command& command)
+{
+    m_commandsSubmitted++;
+    if (command.type == Command::Type::SetTransform)
     {
-        return m_physicsCommon.createCapsuleShape(component.capsuleRadius, component.capsuleHeight);
+        m_pendingTeleports[command.entity] = m_commandsSubmitted;
     }
 
-    case CollisionShapeType::Plane:
+    if (!isThreaded())
     {
-        // Create a very thin box for plane collision
-        rp3d::Vector3 halfExtents = toReactVector(component.boxHalfExtents);
-        halfExtents.y = 0.01f; // Very thin
-        return m_physicsCommon.createBoxShape(halfExtents);
+        executeCommand(command);
+        return;
     }
 
-    default:
-        printf("Unknown collision shape type\n");
-        return m_physicsCommon.createBoxShape(rp3d::Vector3(0.5f, 0.5f, 0.5f));
+    {
+        std::lock_guard<std::mutex> lock(m_commandMutex);
+        m_pendingCommands.push_back(command);
     }
+    m_commandSignal.notify_one();
 }
 
-void PhysicsSystem::update(float deltaTime)
+void PhysicsSystem::addPhysicsComponent(EntityID entity, const PhysicsComponent& component)
 {
     if (!m_initialized)
+    {
+        printf("PhysicsSystem not initialized\n");
         return;
+    }
 
-    // Fixed timestep physics integration
-    m_accumulator += deltaTime;
+    auto& componentManager = m_componentManager;
+    auto* transformComp = componentManager.getComponent<TransformComponent>(entity);
 
-    while (m_accumulator >= m_fixedTimeStep)
+    if (transformComp)
     {
-        m_physicsWorld->update(m_fixedTimeStep);
-        m_accumulator -= m_fixedTimeStep;
+        submit({
+            .type = Command::Type::AddBody,
+            .entity = entity,
+            .component = component,
+            .vector = transformComp->position,
+            .rotation = transformComp->rotation });
+    }
+    else
+    {
+        printf("Entity missing TransformComponent for physics initialization\n");
     }
 
-    // Sync transforms from physics to ECS
-    auto& componentManager = ComponentManager::getInstance();
-
-    auto* physicsArray = componentManager.getComponentArray<PhysicsComponent>();
+    componentManager.addComponent(entity, PhysicsComponent(component));
+}
 
+void PhysicsSystem::removePhysicsComponent(EntityID entity)
+{
+    auto& componentManager = m_componentManager;
+    if (!componentManager.hasComponent<PhysicsComponent>(entity))
+        return;
 
-    if (physicsArray)
+    if (m_initialized)
     {
-        // FIX: Use range-based for loop with non-const references
-        for (auto& pair : *physicsArray)
-        {
-            EntityID entity = pair.first;
-            const PhysicsComponent& physicsComp = pair.second;
-
-            if (physicsComp.rigidBody && physicsComp.bodyType == PhysicsBodyType::Dynamic)
-            {
-                syncTransformFromPhysics(entity, physicsComp);
-            }
-        }
+        submit({ .type = Command::Type::RemoveBody, .entity = entity });
     }
+    m_pendingTeleports.erase(entity);
+
+    componentManager.removeComponent<PhysicsComponent>(entity);
 }
 
-void PhysicsSystem::initializePhysicsBody(EntityID entity, PhysicsComponent& component)
+void PhysicsSystem::updatePhysicsComponent(EntityID entity, const PhysicsComponent& component)
 {
-    auto& componentManager = ComponentManager::getInstance();
-    auto* transformComp = componentManager.getComponent<TransformComponent>(entity);
-
-    if (!transformComp)
+    auto& componentManager = m_componentManager;
+    auto* physicsComp = componentManager.getComponent<PhysicsComponent>(entity);
+    if (!physicsComp)
     {
-        printf("Entity missing TransformComponent for physics initialization\n");
+        addPhysicsComponent(entity, component);
         return;
     }
 
-    // Create collision shape
-    rp3d::CollisionShape* shape = createCollisionShape(component.shapeType, component);
-    if (!shape)
+    *physicsComp = component;
+
+    if (m_initialized)
     {
-        printf("Failed to create collision shape\n");
-        return;
+        // The pose is only used if the body was never created
+        Command command{ .type = Command::Type::UpdateBody, .entity = entity, .component = component };
+        if (auto* transformComp = componentManager.getComponent<TransformComponent>(entity))
+        {
+            command.vector = transformComp->position;
+            command.rotation = transformComp->rotation;
+        }
+        submit(command);
     }
+}
 
-    // Create rigid body
-    rp3d::Vector3 position = toReactVector(transformComp->position);
-    rp3d::Quaternion orientation = toReactQuaternion(transformComp->rotation);
-    rp3d::Transform transform(position, orientation);
+void PhysicsSystem::applyForce(EntityID entity, const Vector3& force)
+{
+    submit({ .type = Command::Type::ApplyForce, .entity = entity, .vector = force });
+}
 
-    component.rigidBody = m_physicsWorld->createRigidBody(transform);
+void PhysicsSystem::applyImpulse(EntityID entity, const Vector3& impulse)
+{
+    submit({ .type = Command::Type::ApplyImpulse, .entity = entity, .vector = impulse });
+}
 
-    if (!component.rigidBody)
-    {
-        printf("Failed to create rigid body\n");
-        return;
-    }
+void PhysicsSystem::setLinearVelocity(EntityID entity, const Vector3& velocity)
+{
+    submit({ .type = Command::Type::SetLinearVelocity, .entity = entity, .vector = velocity });
 
-    // Set body type
-    switch (component.bodyType)
+    if (auto* physicsComp = m_componentManager.getComponent<PhysicsComponent>(entity))
     {
-    case PhysicsBodyType::Static:
-        component.rigidBody->setType(rp3d::BodyType::STATIC);
-        break;
-    case PhysicsBodyType::Kinematic:
-        component.rigidBody->setType(rp3d::BodyType::KINEMATIC);
-        break;
-    case PhysicsBodyType::Dynamic:
-        component.rigidBody->setType(rp3d::BodyType::DYNAMIC);
-        break;
+        physicsComp->linearVelocity = velocity;
     }
+}
 
-    // Add collider
-    component.collider = component.rigidBody->addCollider(shape, rp3d::Transform::identity());
+void PhysicsSystem::setBodyTransform(EntityID entity, const Vector3& position, const Quaternion& rotation)
+{
+    submit({ .type = Command::Type::SetTransform, .entity = entity, .vector = position, .rotation = rotation });
+}
 
-    if (!component.collider)
+void PhysicsSystem::applyMaterial(EntityID entity)
+{
+    auto* physicsComp = m_componentManager.getComponent<PhysicsComponent>(entity);
+    if (!physicsComp)
+        return;
+
+    submit({ .type = Command::Type::SetMaterial, .entity = entity, .component = *physicsComp });
+}
+
+void PhysicsSystem::addTerrain(EntityID entity, const TerrainComponent& terrain)
+{
+    if (!m_initialized)
     {
-        printf("Failed to add collider to rigid body\n");
+        printf("PhysicsSystem not initialized\n");
         return;
     }
 
-    // Set physics properties
-    if (component.bodyType == PhysicsBodyType::Dynamic)
+    auto& componentManager = m_componentManager;
+    auto* transformComp = componentManager.getComponent<TransformComponent>(entity);
+
+    if (transformComp && terrain.heightMap)
     {
-        component.rigidBody->setMass(component.mass);
+        submit({
+            .type = Command::Type::AddTerrain,
+            .entity = entity,
+            .terrain = terrain,
+            .vector = transformComp->position });
+    }
+    else
+    {
+        printf("Terrain needs a TransformComponent and a height map\n");
     }
 
-    rp3d::Material& material = component.collider->getMaterial();
-    material.setBounciness(component.restitution);
-    material.setFrictionCoefficient(component.friction);
-
-    component.isInitialized = true;
+    componentManager.addComponent(entity, TerrainComponent(terrain));
 }
 
-void PhysicsSystem::syncTransformFromPhysics(EntityID entity, const PhysicsComponent& component)
+void PhysicsSystem::removeTerrain(EntityID entity)
 {
-    if (!component.rigidBody)
+    auto& componentManager = m_componentManager;
+    if (!componentManager.hasComponent<TerrainComponent>(entity))
         return;
 
-    auto& componentManager = ComponentManager::getInstance();
-    auto* transformComp = componentManager.getComponent<TransformComponent>(entity);
+    if (m_initialized)
+    {
+        submit({ .type = Command::Type::RemoveTerrain, .entity = entity });
+    }
 
-    if (!transformComp)
-        return;
+    componentManager.removeComponent<TerrainComponent>(entity);
+}
+
+bool PhysicsSystem::raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit)
+{
+    if (!m_initialized || maxDistance <= 0.0f)
+        return false;
 
-    // Get physics transform
-    const rp3d::Transform& physicsTransform = component.rigidBody->getTransform();
+    RaycastQuery query;
+    query.origin = origin;
+    query.direction = direction;
+    query.maxDistance = maxDistance;
 
-    // Update transform component
-    transformComp->position = fromReactVector(physicsTransform.getPosition());
-    transformComp->rotation = fromReactQuaternion(physicsTransform.getOrientation());
+    if (isThreaded())
+    {
+        std::future<void> done = query.done.get_future();
+        submit({ .type = Command::Type::Raycast, .query = &query });
+        done.wait();
+    }
+    else
+    {
+        runRaycast(query);
+    }
 
-    // Scale is not affected by physics
+    if (query.found)
+        hit = query.hit;
+    return query.found;
 }
 
-// Utility conversion functions
-rp3d::Vector3 PhysicsSystem::toReactVector(const Vector3& vec)
+void PhysicsSystem::runRaycast(RaycastQuery& query)
 {
-    return rp3d::Vector3(vec.x, vec.y, vec.z);
+    rp3d::Vector3 from = toReactVector(query.origin);
+    rp3d::Vector3 to = toReactVector(query.origin + query.direction * query.maxDistance);
+
+    ClosestHitCallback callback;
+    m_physicsWorld->raycast(rp3d::Ray(from, to), &callback);
+
+    query.found = callback.entity != INVALID_ENTITY;
+    if (query.found)
+    {
+        query.hit.entity = callback.entity;
+        query.hit.distance = callback.hitFraction * query.maxDistance;
+        query.hit.point = fromReactVector(callback.point);
+        query.hit.normal = fromReactVector(callback.normal);
+    }
 }
 
-Vector3 PhysicsSystem::fromReactVector(const rp3d::Vector3& vec)
+const std::vector<CollisionEvent>& PhysicsSystem::getCollisionEvents() const
 {
-    return Vector3(vec.x, vec.y, vec.z);
+    return m_eventsFresh ? m_snapshots[m_readSnapshot].events : m_noEvents;
 }
 
-rp3d::Quaternion PhysicsSystem::toReactQuaternion(const Vector3& eulerAngles)
+bool PhysicsSystem::saveRecording(const std::string& path)
 {
-    // Convert Euler angles to quaternion
-    float cx = std::cos(eulerAngles.x * 0.5f);
-    float sx = std::sin(eulerAngles.x * 0.5f);
-    float cy = std::cos(eulerAngles.y * 0.5f);
-    float sy = std::sin(eulerAngles.y * 0.5f);
-    float cz = std::cos(eulerAngles.z * 0.5f);
-    float sz = std::sin(eulerAngles.z * 0.5f);
+    if (!m_initialized)
+        return false;
 
-    rp3d::Quaternion quat;
-    quat.w = cx * cy * cz + sx * sy * sz;
-    quat.x = sx * cy * cz - cx * sy * sz;
-    quat.y = cx * sy * cz + sx * cy * sz;
-    quat.z = cx * cy * sz - sx * sy * cz;
+    SaveQuery query;
+    query.path = path;
+
+    if (isThreaded())
+    {
+        std::future<void> done = query.done.get_future();
+        submit({ .type = Command::Type::SaveRecording, .save = &query });
+        done.wait();
+    }
+    else
+    {
+        query.saved = m_recording && m_recorder.save(path);
+    }
 
-    return quat;
+    if (!query.saved)
+        printf("Could not save physics recording to %s\n", path.c_str());
+    return query.saved;
 }
 
-Vector3 PhysicsSystem::fromReactQuaternion(const rp3d::Quaternion& quat)
+bool PhysicsSystem::replay(const std::string& path, ReplayReport& report,
+    const std::function<void(ui32 steps, double milliseconds)>& onSteps)
 {
-    // Convert quaternion to Euler angles
-    Vector3 euler;
+    if (!m_initialized || isThreaded())
+        return false;
 
-    // Roll (x-axis rotation)
-    float sinr_cosp = 2 * (quat.w * quat.x + quat.y * quat.z);
-    float cosr_cosp = 1 - 2 * (quat.x * quat.x + quat.y * quat.y);
-    euler.x = std::atan2(sinr_cosp, cosr_cosp);
+    PhysicsLogReader reader;
+    if (!reader.load(path))
+    {
+        printf("Could not read physics recording %s\n", path.c_str());
+        return false;
+    }
 
-    // Pitch (y-axis rotation)
-    float sinp = 2 * (quat.w * quat.y - quat.z * quat.x);
-    if (std::abs(sinp) >= 1)
-        euler.y = std::copysign(3.14159265f / 2, sinp);
-    else
-        euler.y = std::asin(sinp);
+    // Start from nothing, and keep the replay itself out of the log
+    bool recordingEnabled = m_recordingEnabled.exchange(false);
+    m_recording = false;
+    resetWorld();
+
+    // Nothing builds snapshots during a replay to hand events out, so none
+    // are collected rather than piling up for the next step to report
+    ui32 eventFilter = m_eventFilter.exchange(0);
+
+    float fixedTimeStep = m_fixedTimeStep;
+    std::uint64_t commandsApplied = m_commandsApplied;
+    report = ReplayReport();
+
+    bool started = false;
+    bool skipping = false;
+    PhysicsLogEntry entry;
+    while (reader.next(entry))
+    {
+        if (entry.type == PhysicsRecord::KeyframeBegin)
+        {
+            // Later keyframes restate the world the replay already has
+            if (!started)
+                report.exact = entry.fromEmptyWorld;
+            skipping = started;
+            started = true;
+            continue;
+        }
+
+        if (entry.type == PhysicsRecord::KeyframeEnd)
+        {
+            skipping = false;
+            continue;
+        }
+
+        if (skipping)
+            continue;
+
+        if (entry.type == PhysicsRecord::BodyState)
+        {
+            if (Body* body = findBody(entry.entity))
+            {
+                body->rigidBody->setLinearVelocity(toReactVector(entry.vector));
+                body->rigidBody->setAngularVelocity(toReactVector(entry.angularVelocity));
+                body->rigidBody->setIsSleeping(entry.sleeping);
+            }
+            continue;
+        }
+
+        if (entry.type == PhysicsRecord::Steps)
+        {
+            m_fixedTimeStep = entry.timeStep;
+
+            auto start = std::chrono::steady_clock::now();
+            runSteps(entry.stepCount);
+            auto end = std::chrono::steady_clock::now();
+
+            report.steps += entry.stepCount;
+            if (onSteps)
+                onSteps(entry.stepCount, std::chrono::duration<double, std::milli>(end - start).count());
+
+            if (report.exact)
+            {
+                report.checksumsCompared++;
+                if (computeChecksum() != entry.checksum && report.mismatches++ == 0)
+                    report.firstMismatchStep = report.steps;
+            }
+            continue;
+        }
+
+        Command command{
+            .type = Command::Type::AddBody,
+            .entity = entry.entity,
+            .component = entry.component,
+            .terrain = entry.terrain,
+            .vector = entry.vector,
+            .rotation = entry.rotation };
+
+        switch (entry.type)
+        {
+        case PhysicsRecord::AddBody: command.type = Command::Type::AddBody; break;
+        case PhysicsRecord::RemoveBody: command.type = Command::Type::RemoveBody; break;
+        case PhysicsRecord::UpdateBody: command.type = Command::Type::UpdateBody; break;
+        case PhysicsRecord::ApplyForce: command.type = Command::Type::ApplyForce; break;
+        case PhysicsRecord::ApplyImpulse: command.type = Command::Type::ApplyImpulse; break;
+        case PhysicsRecord::SetLinearVelocity: command.type = Command::Type::SetLinearVelocity; break;
+        case PhysicsRecord::SetTransform: command.type = Command::Type::SetTransform; break;
+        case PhysicsRecord::SetMaterial: command.type = Command::Type::SetMaterial; break;
+        case PhysicsRecord::AddTerrain: command.type = Command::Type::AddTerrain; break;
+        case PhysicsRecord::RemoveTerrain: command.type = Command::Type::RemoveTerrain; break;
+        default: continue;
+        }
+        executeCommand(command);
+    }
+
+    m_fixedTimeStep = fixedTimeStep;
+    m_commandsApplied = commandsApplied;
+    m_recordingEnabled.store(recordingEnabled);
+    m_eventFilter.store(eventFilter);
+    m_collisionEvents.clear();
+    m_eventBatches.clear();
+    m_batchedEventCount = 0;
+    m_eventsFresh = false;
 
-    // Yaw (z-axis rotation)
-    float siny_cosp = 2 * (quat.w * quat.z + quat.x * quat.y);
-    float cosy_cosp = 1 - 2 * (quat.y * quat.y + quat.z * quat.z);
-    euler.z = std::atan2(siny_cosp, cosy_cosp);
+    if (!started || reader.isDamaged())
+    {
+        printf("Physics recording %s is damaged\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool PhysicsSystem::prepareRecording()
+{
+    bool enabled = m_recordingEnabled.load();
+    if (enabled && !m_recording)
+    {
+        m_recorder.clear();
+        m_recorder.setBudget(m_recordingBudget.load());
+        m_recorder.beginSegment();
+        writeKeyframe();
+    }
+
+    m_recording = enabled;
+    return enabled;
+}
 
-    return euler;
+void PhysicsSystem::recordCommand(const Command& command)
+{
+    switch (command.type)
+    {
+    case Command::Type::AddBody:
+        m_recorder.body(PhysicsRecord::AddBody, command.entity, command.component, command.vector, command.rotation);
+        break;
+    case Command::Type::UpdateBody:
+        m_recorder.body(PhysicsRecord::UpdateBody, command.entity, command.component, command.vector, command.rotation);
+        break;
+    case Command::Type::RemoveBody:
+        m_recorder.remove(PhysicsRecord::RemoveBody, command.entity);
+        break;
+    case Command::Type::ApplyForce:
+        m_recorder.vector(PhysicsRecord::ApplyForce, command.entity, command.vector);
+        break;
+    case Command::Type::ApplyImpulse:
+        m_recorder.vector(PhysicsRecord::ApplyImpulse, command.entity, command.vector);
+        break;
+    case Command::Type::SetLinearVelocity:
+        m_recorder.vector(PhysicsRecord::SetLinearVelocity, command.entity, command.vector);
+        break;
+    case Command::Type::SetTransform:
+        m_recorder.transform(command.entity, command.vector, command.rotation);
+        break;
+    case Command::Type::SetMaterial:
+        m_recorder.material(command.entity, command.component);
+        break;
+    case Command::Type::AddTerrain:
+        m_recorder.terrain(command.entity, command.terrain, command.vector);
+        break;
+    case Command::Type::RemoveTerrain:
+        m_recorder.remove(PhysicsRecord::RemoveTerrain, command.entity);
+        break;
+    default:
+        break;
+    }
+}
+
+void PhysicsSystem::writeKeyframe()
+{
+    m_recorder.keyframeBegin(!m_worldUsed);
+
+    for (const Terrain& terrain : m_terrains)
+    {
+        m_recorder.terrain(terrain.entity, terrain.component, terrain.position);
+    }
+
+    for (size_t i = 0; i < m_bodies.size(); ++i)
+    {
+        const Body& body = m_bodies[i];
+        const rp3d::Transform& transform = body.rigidBody->getTransform();
+        m_recorder.body(PhysicsRecord::AddBody, body.entity, m_bodyComponents[i],
+            fromReactVector(transform.getPosition()), fromReactQuaternion(transform.getOrientation()));
+        m_recorder.bodyState(body.entity,
+            fromReactVector(body.rigidBody->getLinearVelocity()),
+            fromReactVector(body.rigidBody->getAngularVelocity()),
+            body.rigidBody->isSleeping());
+    }
+
+    m_recorder.keyframeEnd();
+}
+
+std::uint64_t PhysicsSystem::computeChecksum() const
+{
+    // FNV-1a over the bits of every dynamic body's pose, a word at a time
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](std::uint32_t word)
+        {
+            hash ^= word;
+            hash *= 1099511628211ull;
+        };
+
+    for (const Body& body : m_bodies)
+    {
+        if (!body.isDynamic)
+            continue;
+
+        const rp3d::Transform& transform = body.rigidBody->getTransform();
+        const rp3d::Vector3& position = transform.getPosition();
+        const rp3d::Quaternion& orientation = transform.getOrientation();
+        float values[7] = { position.x, position.y, position.z, orientation.x, orientation.y, orientation.z, orientation.w };
+
+        mix(body.entity);
+        for (float value : values)
+        {
+            std::uint32_t word;
+            std::memcpy(&word, &value, sizeof(word));
+            mix(word);
+        }
+    }
+    return hash;
+}
+
+void PhysicsSystem::resetWorld()
+{
+    while (!m_bodies.empty())
+    {
+        destroyBody(m_bodies.back().entity);
+    }
+    while (!m_terrains.empty())
+    {
+        destroyTerrain(m_terrains.back().entity);
+    }
+    m_pendingTeleports.clear();
+    m_collisionEvents.clear();
+    m_eventBatches.clear();
+    m_batchedEventCount = 0;
+
+    // rp3d recycles its internal slots, so only a new world steps exactly
+    // like the one a recording started from
+    m_physicsCommon.destroyPhysicsWorld(m_physicsWorld);
+    createWorld();
+}
+
+Vector3 PhysicsSystem::getLinearVelocity(EntityID entity) const
+{
+    if (!isThreaded())
+    {
+        auto it = m_bodyIndex.find(entity);
+        if (it != m_bodyIndex.end())
+            return fromReactVector(m_bodies[it->second].rigidBody->getLinearVelocity());
+    }
+
+    const auto* physicsComp = m_componentManager.getComponent<PhysicsComponent>(entity);
+    return physicsComp ? physicsComp->linearVelocity : Vector3(0.0f, 0.0f, 0.0f);
+}
+
+void PhysicsSystem::executeCommand(const Command& command)
+{
+    m_commandsApplied++;
+
+    if (command.type == Command::Type::SaveRecording)
+    {
+        command.save->saved = m_recording && m_recorder.save(command.save->path);
+        command.save->done.set_value();
+        return;
+    }
+
+    // Logged ahead of running, so replay sees the same order
+    if (command.type != Command::Type::Raycast && prepareRecording())
+    {
+        recordCommand(command);
+    }
+
+    if (command.type == Command::Type::AddBody)
+    {
+        createBody(command);
+        return;
+    }
+
+    if (command.type == Command::Type::RemoveBody)
+    {
+        destroyBody(command.entity);
+        return;
+    }
+
+    if (command.type == Command::Type::UpdateBody)
+    {
+        updateBody(command);
+        return;
+    }
+
+    if (command.type == Command::Type::AddTerrain)
+    {
+        createTerrain(command);
+        return;
+    }
+
+    if (command.type == Command::Type::RemoveTerrain)
+    {
+        destroyTerrain(command.entity);
+        return;
+    }
+
+    if (command.type == Command::Type::Raycast)
+    {
+        runRaycast(*command.query);
+        command.query->done.set_value();
+        return;
+    }
+
+    Body* body = findBody(command.entity);
+    if (!body)
+        return;
+
+    rp3d::RigidBody* rigidBody = body->rigidBody;
+    switch (command.type)
+    {
+    case Command::Type::ApplyForce:
+        rigidBody->applyWorldForceAtCenterOfMass(toReactVector(command.vector));
+        break;
+
+    case Command::Type::ApplyImpulse:
+        rigidBody->setLinearVelocity(rigidBody->getLinearVelocity() + toReactVector(command.vector) / rigidBody->getMass());
+        break;
+
+    case Command::Type::SetLinearVelocity:
+        rigidBody->setLinearVelocity(toReactVector(command.vector));
+        break;
+
+    case Command::Type::SetTransform:
+        rigidBody->setTransform(rp3d::Transform(toReactVector(command.vector), toReactQuaternion(command.rotation)));
+
+        // A teleport should not be blended from the old pose
+        body->previousPosition = command.vector;
+        body->previousRotation = command.rotation;
+        body->movedSequence = m_sequence + 1;
+        break;
+
+    case Command::Type::SetMaterial:
+    {
+        if (body->isDynamic)
+        {
+            rigidBody->setMass(command.component.mass);
+        }
+
+        rp3d::Material& material = body->collider->getMaterial();
+        material.setBounciness(command.component.restitution);
+        material.setFrictionCoefficient(command.component.friction);
+
+        PhysicsComponent& component = m_bodyComponents[body - m_bodies.data()];
+        component.mass = command.component.mass;
+        component.restitution = command.component.restitution;
+        component.friction = command.component.friction;
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+void PhysicsSystem::createBody(const Command& command)
+{
+    // Re-adding replaces the old body
+    destroyBody(command.entity);
+    m_worldUsed = true;
+
+    const PhysicsComponent& component = command.component;
+
+    // Create collision shape
+    rp3d::CollisionShape* shape = createCollisionShape(component.shapeType, component);
+    if (!shape)
+    {
+        printf("Failed to create collision shape\n");
+        return;
+    }
+
+    // Create rigid body
+    rp3d::Transform transform(toReactVector(command.vector), toReactQuaternion(command.rotation));
+    rp3d::RigidBody* rigidBody = m_physicsWorld->createRigidBody(transform);
+
+    if (!rigidBody)
+    {
+        printf("Failed to create rigid body\n");
+        releaseCollisionShape(shape);
+        return;
+    }
+    rigidBody->setUserData(toUserData(command.entity));
+
+    rigidBody->setType(toReactBodyType(component.bodyType));
+
+    // Add collider
+    rp3d::Collider* collider = rigidBody->addCollider(shape, rp3d::Transform::identity());
+
+    if (!collider)
+    {
+        printf("Failed to add collider to rigid body\n");
+        m_physicsWorld->destroyRigidBody(rigidBody);
+        releaseCollisionShape(shape);
+        return;
+    }
+
+    // Set physics properties
+    if (component.bodyType == PhysicsBodyType::Dynamic)
+    {
+        rigidBody->setMass(component.mass);
+    }
+
+    rp3d::Material& material = collider->getMaterial();
+    material.setBounciness(component.restitution);
+    material.setFrictionCoefficient(component.friction);
+    collider->setIsTrigger(component.isTrigger);
+    collider->setUserData(toUserData(component.eventTags));
+
+    Body body;
+    body.entity = command.entity;
+    body.rigidBody = rigidBody;
+    body.collider = collider;
+    body.isDynamic = component.bodyType == PhysicsBodyType::Dynamic;
+    body.movedSequence = m_sequence + 1;
+    body.previousPosition = command.vector;
+    body.previousRotation = command.rotation;
+
+    m_bodyIndex[command.entity] = m_bodies.size();
+    m_bodies.push_back(body);
+    m_bodyComponents.push_back(component);
+}
+
+void PhysicsSystem::updateBody(const Command& command)
+{
+    Body* body = findBody(command.entity);
+    if (!body)
+    {
+        createBody(command);
+        return;
+    }
+
+    const PhysicsComponent& component = command.component;
+    rp3d::RigidBody* rigidBody = body->rigidBody;
+
+    // Shapes come from the cache, so an unchanged shape is the same pointer
+    // and the collider can stay
+    rp3d::CollisionShape* oldShape = body->collider->getCollisionShape();
+    rp3d::CollisionShape* shape = createCollisionShape(component.shapeType, component);
+    if (shape == oldShape)
+    {
+        releaseCollisionShape(shape);
+    }
+    else if (shape)
+    {
+        rigidBody->removeCollider(body->collider);
+        body->collider = rigidBody->addCollider(shape, rp3d::Transform::identity());
+        releaseCollisionShape(oldShape);
+        rigidBody->setIsSleeping(false);
+    }
+
+    bool isDynamic = component.bodyType == PhysicsBodyType::Dynamic;
+    if (rigidBody->getType() != toReactBodyType(component.bodyType))
+    {
+        rigidBody->setType(toReactBodyType(component.bodyType));
+        body->isDynamic = isDynamic;
+        body->movedSequence = m_sequence + 1;
+    }
+
+    if (isDynamic)
+    {
+        rigidBody->setMass(component.mass);
+    }
+
+    rp3d::Material& material = body->collider->getMaterial();
+    material.setBounciness(component.restitution);
+    material.setFrictionCoefficient(component.friction);
+    body->collider->setIsTrigger(component.isTrigger);
+    body->collider->setUserData(toUserData(component.eventTags));
+
+    m_bodyComponents[body - m_bodies.data()] = component;
+}
+
+void PhysicsSystem::destroyBody(EntityID entity)
+{
+    auto it = m_bodyIndex.find(entity);
+    if (it == m_bodyIndex.end())
+        return;
+
+    size_t index = it->second;
+    Body& body = m_bodies[index];
+
+    // The shape must outlive its collider, so it is released after the body
+    rp3d::CollisionShape* shape = body.collider ? body.collider->getCollisionShape() : nullptr;
+    m_physicsWorld->destroyRigidBody(body.rigidBody);
+    if (shape)
+    {
+        releaseCollisionShape(shape);
+    }
+
+    // Swap-remove to keep the bodies packed
+    if (index + 1 != m_bodies.size())
+    {
+        m_bodies[index] = m_bodies.back();
+        m_bodyComponents[index] = std::move(m_bodyComponents.back());
+        m_bodyIndex[m_bodies[index].entity] = index;
+    }
+    m_bodies.pop_back();
+    m_bodyComponents.pop_back();
+    m_bodyIndex.erase(entity);
+}
+
+PhysicsSystem::Body* PhysicsSystem::findBody(EntityID entity)
+{
+    auto it = m_bodyIndex.find(entity);
+    return it != m_bodyIndex.end() ? &m_bodies[it->second] : nullptr;
+}
+
+rp3d::BodyType PhysicsSystem::toReactBodyType(PhysicsBodyType type)
+{
+    switch (type)
+    {
+    case PhysicsBodyType::Static:
+        return rp3d::BodyType::STATIC;
+    case PhysicsBodyType::Kinematic:
+        return rp3d::BodyType::KINEMATIC;
+    default:
+        return rp3d::BodyType::DYNAMIC;
+    }
+}
+
+rp3d::CollisionShape* PhysicsSystem::createCollisionShape(CollisionShapeType type, const PhysicsComponent& component)
+{
+    // rp3d only collides concave shapes against static and kinematic bodies
+    if (type == CollisionShapeType::TriangleMesh && component.bodyType == PhysicsBodyType::Dynamic)
+        type = CollisionShapeType::ConvexHull;
+
+    switch (type)
+    {
+    case CollisionShapeType::Box:
+    {
+        const Vector3& halfExtents = component.boxHalfExtents;
+        return acquireShape(rp3d::CollisionShapeName::BOX, halfExtents.x, halfExtents.y, halfExtents.z);
+    }
+
+    case CollisionShapeType::Sphere:
+    {
+        return acquireShape(rp3d::CollisionShapeName::SPHERE, component.sphereRadius);
+    }
+
+    case CollisionShapeType::Cylinder:
+    {
+        return acquireShape(rp3d::CollisionShapeName::CAPSULE, component.cylinderRadius, component.cylinderHeight);
+    }
+
+    case CollisionShapeType::Capsule:
+    {
+        return acquireShape(rp3d::CollisionShapeName::CAPSULE, component.capsuleRadius, component.capsuleHeight);
+    }
+
+    case CollisionShapeType::Plane:
+    {
+        // Create a very thin box for plane collision
+        const Vector3& halfExtents = component.boxHalfExtents;
+        return acquireShape(rp3d::CollisionShapeName::BOX, halfExtents.x, 0.01f, halfExtents.z);
+    }
+
+    case CollisionShapeType::ConvexHull:
+    case CollisionShapeType::TriangleMesh:
+    {
+        const Vector3& scale = component.meshScale;
+        bool convex = type == CollisionShapeType::ConvexHull;
+        BakedMesh* mesh = component.collisionMesh ? bakeMesh(*component.collisionMesh, convex) : nullptr;
+        if (!mesh)
+        {
+            printf("Mesh collider unavailable, falling back to a box\n");
+            return acquireShape(rp3d::CollisionShapeName::BOX, scale.x * 0.5f, scale.y * 0.5f, scale.z * 0.5f);
+        }
+
+        rp3d::CollisionShapeName name = convex ? rp3d::CollisionShapeName::CONVEX_MESH : rp3d::CollisionShapeName::TRIANGLE_MESH;
+        return acquireShape(name, scale.x, scale.y, scale.z, mesh);
+    }
+
+    default:
+        printf("Unknown collision shape type\n");
+        return acquireShape(rp3d::CollisionShapeName::BOX, 0.5f, 0.5f, 0.5f);
+    }
+}
+
+rp3d::CollisionShape* PhysicsSystem::acquireShape(rp3d::CollisionShapeName name, float a, float b, float c, BakedMesh* mesh)
+{
+    // At least one quantum, so rounding never turns a tiny valid size into
+    // a zero rp3d rejects
+    auto quantize = [](float value)
+        {
+            return std::max<i32>(1, static_cast<i32>(std::lround(value / SHAPE_QUANTUM)));
+        };
+    ShapeKey key = { name, { quantize(a), quantize(b), quantize(c) }, mesh };
+
+    CachedShape& cached = m_shapeCache[key];
+    if (!cached.shape)
+    {
+        // Built from the quantized values so every user of the key gets
+        // exactly the same shape
+        float x = key.dimensions[0] * SHAPE_QUANTUM;
+        float y = key.dimensions[1] * SHAPE_QUANTUM;
+        float z = key.dimensions[2] * SHAPE_QUANTUM;
+
+        switch (name)
+        {
+        case rp3d::CollisionShapeName::SPHERE:
+            cached.shape = m_physicsCommon.createSphereShape(x);
+            break;
+        case rp3d::CollisionShapeName::CAPSULE:
+            cached.shape = m_physicsCommon.createCapsuleShape(x, y);
+            break;
+        case rp3d::CollisionShapeName::CONVEX_MESH:
+            cached.shape = m_physicsCommon.createConvexMeshShape(mesh->convexMesh, rp3d::Vector3(x, y, z));
+            break;
+        case rp3d::CollisionShapeName::TRIANGLE_MESH:
+            cached.shape = m_physicsCommon.createConcaveMeshShape(mesh->triangleMesh, rp3d::Vector3(x, y, z));
+            break;
+        default:
+            cached.shape = m_physicsCommon.createBoxShape(rp3d::Vector3(x, y, z));
+            break;
+        }
+
+        if (mesh)
+            mesh->refCount++;
+        m_shapeKeys[cached.shape] = key;
+    }
+
+    cached.refCount++;
+    return cached.shape;
+}
+
+void PhysicsSystem::releaseCollisionShape(rp3d::CollisionShape* shape)
+{
+    auto keyIt = m_shapeKeys.find(shape);
+    if (keyIt == m_shapeKeys.end())
+        return;
+
+    auto cacheIt = m_shapeCache.find(keyIt->second);
+    if (--cacheIt->second.refCount > 0)
+        return;
+
+    destroyShape(keyIt->second, shape);
+    m_shapeCache.erase(cacheIt);
+    m_shapeKeys.erase(keyIt);
+}
+
+void PhysicsSystem::destroyShape(const ShapeKey& key, rp3d::CollisionShape* shape)
+{
+    switch (shape->getName())
+    {
+    case rp3d::CollisionShapeName::SPHERE:
+        m_physicsCommon.destroySphereShape(static_cast<rp3d::SphereShape*>(shape));
+        break;
+    case rp3d::CollisionShapeName::CAPSULE:
+        m_physicsCommon.destroyCapsuleShape(static_cast<rp3d::CapsuleShape*>(shape));
+        break;
+    case rp3d::CollisionShapeName::CONVEX_MESH:
+        m_physicsCommon.destroyConvexMeshShape(static_cast<rp3d::ConvexMeshShape*>(shape));
+        break;
+    case rp3d::CollisionShapeName::TRIANGLE_MESH:
+        m_physicsCommon.destroyConcaveMeshShape(static_cast<rp3d::ConcaveMeshShape*>(shape));
+        break;
+    default:
+        m_physicsCommon.destroyBoxShape(static_cast<rp3d::BoxShape*>(shape));
+        break;
+    }
+
+    if (key.mesh)
+        releaseBakedMesh(key.mesh);
+}
+
+PhysicsSystem::BakedMesh* PhysicsSystem::bakeMesh(const CollisionMesh& collisionMesh, bool convex)
+{
+    if (collisionMesh.positions.empty() || (!convex && collisionMesh.indices.size() < 3))
+        return nullptr;
+
+    auto [it, inserted] = m_meshCache.try_emplace(collisionMesh.sourcePath);
+    BakedMesh& mesh = it->second;
+    mesh.sourcePath = collisionMesh.sourcePath;
+
+    std::vector<rp3d::Message> messages;
+    if (convex && !mesh.convexMesh)
+    {
+        // QuickHull over the raw vertices
+        rp3d::VertexArray vertexArray(collisionMesh.positions.data(), sizeof(Vector3),
+            static_cast<rp3d::uint32>(collisionMesh.positions.size()),
+            rp3d::VertexArray::DataType::VERTEX_FLOAT_TYPE);
+        mesh.convexMesh = m_physicsCommon.createConvexMesh(vertexArray, messages);
+    }
+    else if (!convex && !mesh.triangleMesh)
+    {
+        rp3d::TriangleVertexArray triangleArray(
+            static_cast<rp3d::uint32>(collisionMesh.positions.size()), collisionMesh.positions.data(), sizeof(Vector3),
+            static_cast<rp3d::uint32>(collisionMesh.indices.size() / 3), collisionMesh.indices.data(), 3 * sizeof(ui32),
+            rp3d::TriangleVertexArray::VertexDataType::VERTEX_FLOAT_TYPE,
+            rp3d::TriangleVertexArray::IndexDataType::INDEX_INTEGER_TYPE);
+        mesh.triangleMesh = m_physicsCommon.createTriangleMesh(triangleArray, messages);
+    }
+
+    for (const rp3d::Message& message : messages)
+    {
+        if (message.type == rp3d::Message::Type::Error)
+            printf("Mesh collider for %s: %s\n", collisionMesh.sourcePath.c_str(), message.text.c_str());
+    }
+
+    if (convex ? mesh.convexMesh != nullptr : mesh.triangleMesh != nullptr)
+        return &mesh;
+
+    // Nothing uses a mesh that never baked
+    if (inserted)
+        m_meshCache.erase(it);
+    return nullptr;
+}
+
+void PhysicsSystem::releaseBakedMesh(BakedMesh* mesh)
+{
+    if (--mesh->refCount > 0)
+        return;
+
+    if (mesh->convexMesh)
+        m_physicsCommon.destroyConvexMesh(mesh->convexMesh);
+    if (mesh->triangleMesh)
+        m_physicsCommon.destroyTriangleMesh(mesh->triangleMesh);
+    m_meshCache.erase(mesh->sourcePath);
+}
+
+void PhysicsSystem::update(float deltaTime)
+{
+    if (!m_initialized)
+        return;
+
+    bool fresh = false;
+    if (isThreaded())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_commandMutex);
+            m_pendingTime += deltaTime;
+        }
+        m_commandSignal.notify_one();
+
+        // Whatever the thread finished last; it never blocks on a step
+        fresh = acquireSnapshot();
+    }
+    else
+    {
+        float timeDilation = 1.0f;
+        ui32 steps = takeSteps(deltaTime, timeDilation);
+        if (steps > 0)
+        {
+            runSteps(steps);
+            buildSnapshot(m_snapshots[m_readSnapshot], timeDilation);
+            m_consumedSequence.store(m_sequence);
+            fresh = true;
+        }
+        else
+        {
+            m_timeDilation = timeDilation;
+        }
+    }
+
+    m_eventsFresh = fresh;
+    if (fresh)
+    {
+        m_timeSinceSnapshot = 0.0f;
+    }
+    else
+    {
+        m_timeSinceSnapshot += deltaTime;
+
+        // Without interpolation bodies can only have moved with a new snapshot
+        if (!m_interpolationEnabled)
+            return;
+    }
+
+    const Snapshot& snapshot = m_snapshots[m_readSnapshot];
+    m_interpolationAlpha = std::min((snapshot.accumulator + m_timeSinceSnapshot) / m_fixedTimeStep, 1.0f);
+    applySnapshot(snapshot, m_interpolationEnabled ? m_interpolationAlpha : 1.0f, fresh);
+}
+
+void PhysicsSystem::step()
+{
+    if (!m_initialized)
+        return;
+
+    if (isThreaded())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_commandMutex);
+            m_pendingSteps++;
+        }
+        m_commandSignal.notify_one();
+        return;
+    }
+
+    runSteps(1);
+    buildSnapshot(m_snapshots[m_readSnapshot], 1.0f);
+    m_consumedSequence.store(m_sequence);
+    m_timeSinceSnapshot = 0.0f;
+    m_eventsFresh = true;
+    applySnapshot(m_snapshots[m_readSnapshot], 1.0f, true);
+}
+
+ui32 PhysicsSystem::takeSteps(float deltaTime, float& timeDilation)
+{
+    // Fixed timestep physics integration, at most m_maxSubsteps per call
+    const float fixedTimeStep = m_fixedTimeStep.load();
+    const ui32 maxSubsteps = m_maxSubsteps.load();
+    m_accumulator += deltaTime;
+
+    ui32 steps = 0;
+    while (m_accumulator >= fixedTimeStep && steps < maxSubsteps)
+    {
+        m_accumulator -= fixedTimeStep;
+        steps++;
+    }
+
+    // Over budget: drop the whole steps we could not afford so the backlog
+    // cannot snowball, which slows the simulation down for this frame
+    timeDilation = 1.0f;
+    if (m_accumulator >= fixedTimeStep)
+    {
+        float dropped = m_accumulator - std::fmod(m_accumulator, fixedTimeStep);
+        m_accumulator -= dropped;
+        timeDilation = 1.0f - dropped / deltaTime;
+    }
+
+    return steps;
+}
+
+void PhysicsSystem::runSteps(ui32 steps)
+{
+    if (steps > 0 && !m_terrains.empty())
+        streamTerrain();
+
+    // One value for the batch, so the recording matches what was stepped
+    const float fixedTimeStep = m_fixedTimeStep.load();
+    for (ui32 i = 0; i < steps; ++i)
+    {
+        // Rendering blends from the state before the last step. Bodies asleep
+        // at the last snapshot already hold their resting pose as the
+        // previous one, so only the ones awake then need reading.
+        if (m_interpolationEnabled && i + 1 == steps)
+        {
+            for (Body& body : m_bodies)
+            {
+                if (!body.isDynamic || !body.isAwake)
+                    continue;
+
+                const rp3d::Transform& transform = body.rigidBody->getTransform();
+                body.previousPosition = fromReactVector(transform.getPosition());
+                body.previousRotation = fromReactQuaternion(transform.getOrientation());
+            }
+        }
+
+        m_physicsWorld->update(fixedTimeStep);
+    }
+
+    if (steps > 0 && prepareRecording())
+    {
+        m_recorder.steps(steps, fixedTimeStep, computeChecksum());
+
+        // Segments only change between steps
+        if (m_recorder.isSegmentFull())
+        {
+            m_recorder.setBudget(m_recordingBudget.load());
+            m_recorder.beginSegment();
+            writeKeyframe();
+        }
+    }
+}
+
+void PhysicsSystem::createTerrain(const Command& command)
+{
+    // Re-adding replaces the old terrain
+    destroyTerrain(command.entity);
+    m_worldUsed = true;
+
+    const HeightMap& heightMap = *command.terrain.heightMap;
+    if (heightMap.columns < 2 || heightMap.rows < 2)
+        return;
+
+    Terrain terrain;
+    terrain.entity = command.entity;
+    terrain.component = command.terrain;
+    terrain.component.tileCells = std::max(terrain.component.tileCells, 1u);
+    terrain.position = command.vector;
+
+    ui32 tileCells = terrain.component.tileCells;
+    terrain.tilesX = (heightMap.columns - 1 + tileCells - 1) / tileCells;
+    terrain.tilesZ = (heightMap.rows - 1 + tileCells - 1) / tileCells;
+
+    m_terrains.push_back(std::move(terrain));
+}
+
+void PhysicsSystem::destroyTerrain(EntityID entity)
+{
+    auto it = std::find_if(m_terrains.begin(), m_terrains.end(),
+        [entity](const Terrain& terrain) { return terrain.entity == entity; });
+    if (it == m_terrains.end())
+        return;
+
+    for (auto& [key, tile] : it->tiles)
+    {
+        destroyTerrainTile(tile);
+    }
+    m_terrains.erase(it);
+}
+
+void PhysicsSystem::streamTerrain()
+{
+    m_streamPass++;
+
+    for (Terrain& terrain : m_terrains)
+    {
+        const HeightMap& heightMap = *terrain.component.heightMap;
+        float radius = terrain.component.streamRadius;
+        float tileSizeX = heightMap.cellSizeX * terrain.component.tileCells;
+        float tileSizeZ = heightMap.cellSizeZ * terrain.component.tileCells;
+        Vector3 corner = terrain.position + heightMap.origin;
+
+        // Only dynamic bodies can touch static ground. Sleeping ones count
+        // too, so the tile under a resting body is still there when it wakes.
+        for (const Body& body : m_bodies)
+        {
+            if (!body.isDynamic)
+                continue;
+
+            const rp3d::Vector3& position = body.rigidBody->getTransform().getPosition();
+            float minX = std::floor((position.x - corner.x - radius) / tileSizeX);
+            float maxX = std::floor((position.x - corner.x + radius) / tileSizeX);
+            float minZ = std::floor((position.z - corner.z - radius) / tileSizeZ);
+            float maxZ = std::floor((position.z - corner.z + radius) / tileSizeZ);
+
+            if (maxX < 0.0f || maxZ < 0.0f || minX >= terrain.tilesX || minZ >= terrain.tilesZ)
+                continue;
+
+            ui32 firstX = static_cast<ui32>(std::max(minX, 0.0f));
+            ui32 lastX = std::min(static_cast<ui32>(maxX), terrain.tilesX - 1);
+            ui32 firstZ = static_cast<ui32>(std::max(minZ, 0.0f));
+            ui32 lastZ = std::min(static_cast<ui32>(maxZ), terrain.tilesZ - 1);
+
+            for (ui32 tileZ = firstZ; tileZ <= lastZ; ++tileZ)
+            {
+                for (ui32 tileX = firstX; tileX <= lastX; ++tileX)
+                {
+                    TerrainTile& tile = terrain.tiles[tileZ * terrain.tilesX + tileX];
+                    if (!tile.rigidBody && !tile.failed)
+                        createTerrainTile(terrain, tileX, tileZ, tile);
+                    tile.lastNeededPass = m_streamPass;
+                }
+            }
+        }
+
+        for (auto it = terrain.tiles.begin(); it != terrain.tiles.end();)
+        {
+            if (it->second.failed || (it->second.rigidBody && it->second.lastNeededPass + TILE_EVICT_DELAY >= m_streamPass))
+            {
+                ++it;
+                continue;
+            }
+
+            destroyTerrainTile(it->second);
+            it = terrain.tiles.erase(it);
+        }
+    }
+}
+
+void PhysicsSystem::createTerrainTile(Terrain& terrain, ui32 tileX, ui32 tileZ, TerrainTile& tile)
+{
+    const HeightMap& heightMap = *terrain.component.heightMap;
+    ui32 tileCells = terrain.component.tileCells;
+
+    // Neighbouring tiles share their border samples so there is no seam
+    ui32 firstColumn = tileX * tileCells;
+    ui32 firstRow = tileZ * tileCells;
+    ui32 columns = std::min(tileCells, heightMap.columns - 1 - firstColumn) + 1;
+    ui32 rows = std::min(tileCells, heightMap.rows - 1 - firstRow) + 1;
+
+    m_tileHeights.resize(static_cast<size_t>(columns) * rows);
+    float minHeight = heightMap.getHeight(firstColumn, firstRow);
+    float maxHeight = minHeight;
+    for (ui32 row = 0; row < rows; ++row)
+    {
+        for (ui32 column = 0; column < columns; ++column)
+        {
+            float height = heightMap.getHeight(firstColumn + column, firstRow + row);
+            m_tileHeights[row * columns + column] = height;
+            minHeight = std::min(minHeight, height);
+            maxHeight = std::max(maxHeight, height);
+        }
+    }
+
+    std::vector<rp3d::Message> messages;
+    tile.heightField = m_physicsCommon.createHeightField(columns, rows, m_tileHeights.data(),
+        rp3d::HeightField::HeightDataType::HEIGHT_FLOAT_TYPE, messages);
+    if (!tile.heightField)
+    {
+        printf("Failed to create terrain tile (%u, %u)\n", tileX, tileZ);
+        tile.failed = true;
+        return;
+    }
+
+    tile.shape = m_physicsCommon.createHeightFieldShape(tile.heightField,
+        rp3d::Vector3(heightMap.cellSizeX, 1.0f, heightMap.cellSizeZ));
+
+    // rp3d centers a heightfield on its bounds, so the body goes to the
+    // middle of the tile and halfway between its lowest and highest sample
+    Vector3 corner = terrain.position + heightMap.origin;
+    rp3d::Vector3 center(
+        corner.x + (firstColumn + 0.5f * (columns - 1)) * heightMap.cellSizeX,
+        corner.y + 0.5f * (minHeight + maxHeight),
+        corner.z + (firstRow + 0.5f * (rows - 1)) * heightMap.cellSizeZ);
+
+    tile.rigidBody = m_physicsWorld->createRigidBody(rp3d::Transform(center, rp3d::Quaternion::identity()));
+    tile.rigidBody->setType(rp3d::BodyType::STATIC);
+    tile.rigidBody->setUserData(toUserData(terrain.entity));
+
+    rp3d::Collider* collider = tile.rigidBody->addCollider(tile.shape, rp3d::Transform::identity());
+    rp3d::Material& material = collider->getMaterial();
+    material.setBounciness(terrain.component.restitution);
+    material.setFrictionCoefficient(terrain.component.friction);
+    collider->setUserData(toUserData(terrain.component.eventTags));
+}
+
+void PhysicsSystem::destroyTerrainTile(TerrainTile& tile)
+{
+    if (tile.rigidBody)
+        m_physicsWorld->destroyRigidBody(tile.rigidBody);
+    if (tile.shape)
+        m_physicsCommon.destroyHeightFieldShape(tile.shape);
+    if (tile.heightField)
+        m_physicsCommon.destroyHeightField(tile.heightField);
+
+    tile = TerrainTile();
+}
+
+void PhysicsSystem::buildSnapshot(Snapshot& snapshot, float timeDilation)
+{
+    snapshot.sequence = ++m_sequence;
+    snapshot.commandsApplied = m_commandsApplied;
+    snapshot.accumulator = m_accumulator;
+    snapshot.timeDilation = timeDilation;
+    snapshot.bodies.clear();
+
+    // A body goes in if it moved since the last snapshot the main thread
+    // took, which covers the ones it skipped when the thread ran ahead.
+    // Settled bodies drop out, so a sleeping scene builds empty snapshots.
+    std::uint64_t consumed = m_consumedSequence.load();
+    for (Body& body : m_bodies)
+    {
+        if (!body.isDynamic)
+            continue;
+
+        // A body that fell asleep during these steps still moved in them
+        bool wasAwake = body.isAwake;
+        body.isAwake = !body.rigidBody->isSleeping();
+        if (wasAwake || body.isAwake)
+            body.movedSequence = snapshot.sequence;
+        if (body.movedSequence <= consumed)
+            continue;
+
+        const rp3d::Transform& transform = body.rigidBody->getTransform();
+        BodyState state;
+        state.entity = body.entity;
+        state.isAwake = body.isAwake;
+        state.position = fromReactVector(transform.getPosition());
+        state.rotation = fromReactQuaternion(transform.getOrientation());
+        state.linearVelocity = fromReactVector(body.rigidBody->getLinearVelocity());
+
+        if (!body.isAwake)
+        {
+            // At rest: show the final pose and blend from it once woken
+            body.previousPosition = state.position;
+            body.previousRotation = state.rotation;
+        }
+        state.previousPosition = body.previousPosition;
+        state.previousRotation = body.previousRotation;
+
+        snapshot.bodies.push_back(state);
+    }
+
+    // Events stay until a snapshot carrying them was taken, for the same
+    // reason. New ones form the batch of this snapshot.
+    size_t takenBatches = 0;
+    size_t takenEvents = 0;
+    while (takenBatches < m_eventBatches.size() && m_eventBatches[takenBatches].sequence <= consumed)
+    {
+        takenEvents += m_eventBatches[takenBatches++].count;
+    }
+    m_eventBatches.erase(m_eventBatches.begin(), m_eventBatches.begin() + takenBatches);
+    m_collisionEvents.erase(m_collisionEvents.begin(), m_collisionEvents.begin() + takenEvents);
+    m_batchedEventCount -= takenEvents;
+
+    if (m_collisionEvents.size() > m_batchedEventCount)
+    {
+        m_eventBatches.push_back({ snapshot.sequence, m_collisionEvents.size() - m_batchedEventCount });
+        m_batchedEventCount = m_collisionEvents.size();
+    }
+    snapshot.events.assign(m_collisionEvents.begin(), m_collisionEvents.end());
+}
+
+bool PhysicsSystem::acquireSnapshot()
+{
+    if (!(m_readySnapshot.load() & SNAPSHOT_FRESH))
+        return false;
+
+    m_readSnapshot = m_readySnapshot.exchange(m_readSnapshot) & ~SNAPSHOT_FRESH;
+    m_consumedSequence.store(m_snapshots[m_readSnapshot].sequence);
+    return true;
+}
+
+void PhysicsSystem::applySnapshot(const Snapshot& snapshot, float alpha, bool fresh)
+{
+    if (fresh)
+    {
+        m_timeDilation = snapshot.timeDilation;
+
+        // Teleports the snapshot already includes no longer need guarding
+        for (auto it = m_pendingTeleports.begin(); it != m_pendingTeleports.end();)
+        {
+            if (it->second <= snapshot.commandsApplied)
+                it = m_pendingTeleports.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    // Copy poses into the ECS, flagging each written transform so
+    // change-tracking consumers pick it up. Re-blending a snapshot already
+    // applied only needs the bodies that were still moving in it.
+    auto& componentManager = m_componentManager;
+    auto* transforms = componentManager.getComponentArray<TransformComponent>();
+    auto* physicsComponents = componentManager.getComponentArray<PhysicsComponent>();
+
+    for (const BodyState& state : snapshot.bodies)
+    {
+        if (!fresh && !state.isAwake)
+            continue;
+
+        // Removed since, or teleported after the snapshot was built
+        PhysicsComponent* physicsComp = physicsComponents->getComponent(state.entity);
+        if (!physicsComp)
+            continue;
+
+        if (!m_pendingTeleports.empty())
+        {
+            auto teleport = m_pendingTeleports.find(state.entity);
+            if (teleport != m_pendingTeleports.end() && teleport->second > snapshot.commandsApplied)
+                continue;
+        }
+
+        TransformComponent* transformComp = transforms->getComponent(state.entity);
+        if (!transformComp)
+            continue;
+
+        if (state.isAwake && alpha < 1.0f)
+        {
+            transformComp->position = Vector3::Lerp(state.previousPosition, state.position, alpha);
+            transformComp->rotation = Quaternion::Nlerp(state.previousRotation, state.rotation, alpha);
+        }
+        else
+        {
+            transformComp->position = state.position;
+            transformComp->rotation = state.rotation;
+        }
+        // Scale is not affected by physics
+
+        physicsComp->linearVelocity = state.linearVelocity;
+        transforms->markChanged(state.entity);
+    }
+}
+
+void PhysicsSystem::threadMain()
+{
+    std::vector<Command> commands;
+
+    while (true)
+    {
+        float deltaTime = 0.0f;
+        ui32 requestedSteps = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_commandMutex);
+            m_commandSignal.wait(lock, [this]()
+                {
+                    return m_stopRequested || !m_pendingCommands.empty() || m_pendingTime > 0.0f || m_pendingSteps > 0;
+                });
+
+            if (m_stopRequested)
+                return;
+
+            commands.swap(m_pendingCommands);
+            deltaTime = m_pendingTime;
+            requestedSteps = m_pendingSteps;
+            m_pendingTime = 0.0f;
+            m_pendingSteps = 0;
+        }
+
+        // Saves wait for the steps handed over with them, so the log holds
+        // everything the caller queued before asking
+        bool saveRequested = false;
+        for (const Command& command : commands)
+        {
+            if (command.type == Command::Type::SaveRecording)
+                saveRequested = true;
+            else
+                executeCommand(command);
+        }
+        bool changed = !commands.empty();
+
+        float timeDilation = 1.0f;
+        ui32 steps = requestedSteps;
+        if (deltaTime > 0.0f)
+            steps += takeSteps(deltaTime, timeDilation);
+
+        if (steps > 0 || changed)
+        {
+            runSteps(steps);
+
+            // Publish: the ready slot becomes ours to fill next time
+            buildSnapshot(m_snapshots[m_writeSnapshot], timeDilation);
+            m_writeSnapshot = m_readySnapshot.exchange(m_writeSnapshot | SNAPSHOT_FRESH) & ~SNAPSHOT_FRESH;
+        }
+
+        if (saveRequested)
+        {
+            for (const Command& command : commands)
+            {
+                if (command.type == Command::Type::SaveRecording)
+                    executeCommand(command);
+            }
+        }
+        commands.clear();
+    }
+}
+
+// Utility conversion functions
+rp3d::Vector3 PhysicsSystem::toReactVector(const Vector3& vec)
+{
+    return rp3d::Vector3(vec.x, vec.y, vec.z);
+}
+
+Vector3 PhysicsSystem::fromReactVector(const rp3d::Vector3& vec)
+{
+    return Vector3(vec.x, vec.y, vec.z);
+}
+
+rp3d::Quaternion PhysicsSystem::toReactQuaternion(const Quaternion& quat)
+{
+    return rp3d::Quaternion(quat.x, quat.y, quat.z, quat.w);
+}
+
+Quaternion PhysicsSystem::fromReactQuaternion(const rp3d::Quaternion& quat)
+{
+    return Quaternion(quat.x, quat.y, quat.z, quat.w);
 }
\ No newline at end of file
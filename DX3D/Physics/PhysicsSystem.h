@@ -1,59 +1,486 @@
 #pragma once
 #include <../ECS/Entity.h>
 #include <../ECS/Components/PhysicsComponent.h>
+#include <../ECS/Components/TerrainComponent.h>
+#include <../Physics/PhysicsRecorder.h>
 #include <reactphysics3d/reactphysics3d.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace dx3d
 {
+    struct TransformComponent;
+    class ComponentManager;
+
+    struct RaycastHit
+    {
+        EntityID entity = INVALID_ENTITY;
+        // Along the ray direction, in world units when it is normalized
+        float distance = 0.0f;
+        Vector3 point;
+        Vector3 normal;
+    };
+
+    // One contact or trigger pair from a physics step. The normal points
+    // from entityA to entityB and the point is averaged over the contact
+    // manifold; both are zero for exits and triggers. rp3d reports contacts
+    // before solving them, so the impulse is an estimate: the normal impulse
+    // needed to stop the pair closing at the point.
+    struct CollisionEvent
+    {
+        enum class Type : std::uint8_t
+        {
+            ContactStart,
+            ContactStay,
+            ContactExit,
+            TriggerEnter,
+            TriggerStay,
+            TriggerExit
+        };
+
+        Type type;
+        EntityID entityA;
+        EntityID entityB;
+        float impulse;
+        Vector3 point;
+        Vector3 normal;
+    };
+
+    struct ReplayReport
+    {
+        std::uint64_t steps = 0;
+        // Whether the recording starts from an empty world. Otherwise its
+        // first keyframe cannot restore rp3d's contact caches, so results
+        // only match closely and checksums are not compared.
+        bool exact = false;
+        std::uint64_t checksumsCompared = 0;
+        std::uint64_t mismatches = 0;
+        // Steps run when the first mismatch was found
+        std::uint64_t firstMismatchStep = 0;
+    };
+
+    // Owns one rp3d world and keeps it in sync with the PhysicsComponents of
+    // the ComponentManager it was created for. Each World has its own.
+    //
+    // The rp3d world belongs to one thread: the caller of update() by
+    // default, or a dedicated physics thread after setThreaded(true). Body
+    // changes are commands that run immediately in the first case and are
+    // queued for the physics thread in the second. Body poses and collision
+    // events come back as snapshots that update() applies; the physics
+    // thread publishes them through a lock-free triple buffer, so the main
+    // thread never waits on a step.
     class PhysicsSystem
     {
     public:
-        static PhysicsSystem& getInstance()
-        {
-            static PhysicsSystem instance;
-            return instance;
-        }
+        // Physics of the calling thread's current World (see Scene/World.h)
+        static PhysicsSystem& getInstance();
+
+        // rp3d takes its memory from allocator when given, which must
+        // outlive the system
+        explicit PhysicsSystem(ComponentManager& componentManager, rp3d::MemoryAllocator* allocator = nullptr);
+        ~PhysicsSystem();
+        PhysicsSystem(const PhysicsSystem&) = delete;
+        PhysicsSystem& operator=(const PhysicsSystem&) = delete;
 
         void initialize();
         void shutdown();
 
-        // Physics world management
+        // Only safe to use directly while not threaded
         rp3d::PhysicsWorld* getPhysicsWorld() { return m_physicsWorld; }
 
-        // Component management
+        // Moves stepping to a dedicated thread, or back to update()'s caller.
+        // Pending commands are carried over either way.
+        void setThreaded(bool threaded);
+        bool isThreaded() const { return m_thread.joinable(); }
+
+        // Component management. Adding reads the entity's TransformComponent
+        // for the initial body pose.
         void addPhysicsComponent(EntityID entity, const PhysicsComponent& component);
         void removePhysicsComponent(EntityID entity);
+        // Edits the existing body in place: only a changed shape swaps the
+        // collider, and the body keeps its contacts and broad-phase entry
         void updatePhysicsComponent(EntityID entity, const PhysicsComponent& component);
 
-        // Shape creation helpers
+        // Body commands
+        void applyForce(EntityID entity, const Vector3& force);
+        void applyImpulse(EntityID entity, const Vector3& impulse);
+        void setLinearVelocity(EntityID entity, const Vector3& velocity);
+        // Teleports the body; it is not blended from its old pose
+        void setBodyTransform(EntityID entity, const Vector3& position, const Quaternion& rotation);
+        // Pushes mass, restitution and friction of the entity's component
+        void applyMaterial(EntityID entity);
+        // Current velocity when inline; as of the last snapshot when threaded
+        Vector3 getLinearVelocity(EntityID entity) const;
+
+        // Contact and trigger events of the steps whose poses the last
+        // update() or step() applied, for systems to read after it. Empty
+        // when no new step was applied.
+        const std::vector<CollisionEvent>& getCollisionEvents() const;
+        // Only pairs where either side has one of these tags are recorded,
+        // which is checked before anything is copied; 0 stops recording
+        void setCollisionEventFilter(ui32 tags) { m_eventFilter.store(tags); }
+        ui32 getCollisionEventFilter() const { return m_eventFilter.load(); }
+
+        // Input recording, on by default: every command that changes the
+        // world and every fixed step go into a PhysicsRecorder ring of
+        // about `bytes`, with a checksum of the dynamic bodies per step
+        void setRecordingEnabled(bool enabled) { m_recordingEnabled.store(enabled); }
+        bool isRecordingEnabled() const { return m_recordingEnabled.load(); }
+        void setRecordingBudget(size_t bytes) { m_recordingBudget.store(bytes); }
+        // Writes out what the ring holds; waits for the physics thread to
+        // take the time already handed to update() first
+        bool saveRecording(const std::string& path);
+        // Clears the world and re-runs a saved recording on it, without
+        // touching any component. Not while threaded. onSteps sees every
+        // run of steps with how long it took.
+        bool replay(const std::string& path, ReplayReport& report,
+            const std::function<void(ui32 steps, double milliseconds)>& onSteps = nullptr);
+
+        // Heightfield ground for a terrain entity, placed at its position
+        // (rotation and scale are ignored). Tiles are streamed in around
+        // dynamic bodies before each batch of steps and evicted once no
+        // body has needed them for TILE_EVICT_DELAY batches.
+        void addTerrain(EntityID entity, const TerrainComponent& terrain);
+        void removeTerrain(EntityID entity);
+
+        // Closest collider along the ray within maxDistance, through rp3d's
+        // broad-phase tree and exact shape tests (triangles for mesh and
+        // terrain colliders). Threaded, the query runs on the physics thread
+        // after the queued commands and the caller waits for it.
+        bool raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit);
+
+        // Shapes are shared between identical colliders: create returns a
+        // cached shape and adds a reference, release drops one and destroys
+        // the shape with the last. Owned by the world's thread like the bodies.
+        // Mesh shapes also share the convex hull or triangle BVH baked for
+        // their model file, so it is only built once.
         rp3d::CollisionShape* createCollisionShape(CollisionShapeType type, const PhysicsComponent& component);
+        void releaseCollisionShape(rp3d::CollisionShape* shape);
+        // Read the caches directly, so only valid while not threaded
+        size_t getCachedShapeCount() const { return m_shapeCache.size(); }
+        size_t getBakedMeshCount() const { return m_meshCache.size(); }
 
-        // Physics simulation
+        // Physics simulation. update() accumulates time and runs at most
+        // getMaxSubsteps() fixed steps per call; time past that budget is
+        // dropped (see getTimeDilation) instead of piling up catch-up steps.
+        // When threaded, it hands the time to the physics thread and applies
+        // the newest published snapshot instead.
         void update(float deltaTime);
+        // Advances exactly one fixed step, e.g. frame stepping while paused
+        void step();
+        // Safe to change while threaded; the physics thread picks the new
+        // values up with its next batch
         void setFixedTimeStep(float timeStep) { m_fixedTimeStep = timeStep; }
+        float getFixedTimeStep() const { return m_fixedTimeStep; }
+        void setMaxSubsteps(ui32 maxSubsteps) { m_maxSubsteps = (maxSubsteps > 0) ? maxSubsteps : 1; }
+        ui32 getMaxSubsteps() const { return m_maxSubsteps; }
+
+        // Share of the last update's time that was simulated; below 1 only
+        // when the substep budget was exceeded
+        float getTimeDilation() const { return m_timeDilation; }
+
+        // Progress into the next fixed step, 0..1. With interpolation on,
+        // dynamic bodies are written to the ECS blended by this between the
+        // last two steps, so rendering stays smooth at low physics rates.
+        float getInterpolationAlpha() const { return m_interpolationAlpha; }
+        void setInterpolationEnabled(bool enabled) { m_interpolationEnabled = enabled; }
+        bool isInterpolationEnabled() const { return m_interpolationEnabled; }
 
         // Utility functions
         static rp3d::Vector3 toReactVector(const Vector3& vec);
         static Vector3 fromReactVector(const rp3d::Vector3& vec);
-        static rp3d::Quaternion toReactQuaternion(const Vector3& eulerAngles);
-        static Vector3 fromReactQuaternion(const rp3d::Quaternion& quat);
+        static rp3d::Quaternion toReactQuaternion(const Quaternion& quat);
+        static Quaternion fromReactQuaternion(const rp3d::Quaternion& quat);
 
     private:
-        PhysicsSystem() = default;
-        ~PhysicsSystem() = default;
-        PhysicsSystem(const PhysicsSystem&) = delete;
-        PhysicsSystem& operator=(const PhysicsSystem&) = delete;
+        // Convex hull and triangle mesh baked from one model file, kept
+        // while any cached shape is built from them
+        struct BakedMesh
+        {
+            std::string sourcePath;
+            rp3d::ConvexMesh* convexMesh = nullptr;
+            rp3d::TriangleMesh* triangleMesh = nullptr;
+            ui32 refCount = 0;
+        };
+
+        // rp3d shape kind plus dimensions quantized to SHAPE_QUANTUM. Mesh
+        // shapes add their baked mesh and use the dimensions for the scale.
+        struct ShapeKey
+        {
+            rp3d::CollisionShapeName name;
+            i32 dimensions[3];
+            BakedMesh* mesh = nullptr;
+
+            bool operator==(const ShapeKey& other) const
+            {
+                return name == other.name && mesh == other.mesh && dimensions[0] == other.dimensions[0] &&
+                    dimensions[1] == other.dimensions[1] && dimensions[2] == other.dimensions[2];
+            }
+        };
+
+        struct ShapeKeyHash
+        {
+            size_t operator()(const ShapeKey& key) const
+            {
+                size_t hash = static_cast<size_t>(key.name) ^ std::hash<const void*>()(key.mesh);
+                for (i32 dimension : key.dimensions)
+                    hash = hash * 31 + std::hash<i32>()(dimension);
+                return hash;
+            }
+        };
+
+        struct CachedShape
+        {
+            rp3d::CollisionShape* shape = nullptr;
+            ui32 refCount = 0;
+        };
+
+        static constexpr float SHAPE_QUANTUM = 0.001f;
 
-        void initializePhysicsBody(EntityID entity, PhysicsComponent& component);
-        void syncTransformFromPhysics(EntityID entity, const PhysicsComponent& component);
+        struct RaycastQuery
+        {
+            Vector3 origin;
+            Vector3 direction;
+            float maxDistance = 0.0f;
+            RaycastHit hit;
+            bool found = false;
+            std::promise<void> done;
+        };
+
+        struct SaveQuery
+        {
+            std::string path;
+            bool saved = false;
+            std::promise<void> done;
+        };
+
+        struct Command
+        {
+            enum class Type
+            {
+                AddBody,
+                RemoveBody,
+                UpdateBody,
+                ApplyForce,
+                ApplyImpulse,
+                SetLinearVelocity,
+                SetTransform,
+                SetMaterial,
+                AddTerrain,
+                RemoveTerrain,
+                Raycast,
+                SaveRecording
+            };
+
+            Type type = Type::AddBody;
+            EntityID entity = INVALID_ENTITY;
+            PhysicsComponent component{};  // AddBody, UpdateBody, SetMaterial
+            TerrainComponent terrain{};    // AddTerrain
+            Vector3 vector{};              // force, impulse, velocity or position
+            Quaternion rotation{};         // AddBody, UpdateBody, SetTransform
+            RaycastQuery* query = nullptr; // Raycast
+            SaveQuery* save = nullptr;     // SaveRecording
+        };
+
+        // rp3d side of a PhysicsComponent, only touched by the thread that
+        // owns the world
+        struct Body
+        {
+            EntityID entity = INVALID_ENTITY;
+            rp3d::RigidBody* rigidBody = nullptr;
+            rp3d::Collider* collider = nullptr;
+            bool isDynamic = false;
+            // Whether the body was awake when the last snapshot was built
+            bool isAwake = true;
+            // Last snapshot the body moved in
+            std::uint64_t movedSequence = 0;
+            // Pose before the last fixed step, for interpolation
+            Vector3 previousPosition;
+            Quaternion previousRotation;
+        };
+
+        // Static rp3d body over one block of a terrain's height map
+        struct TerrainTile
+        {
+            rp3d::RigidBody* rigidBody = nullptr;
+            rp3d::HeightField* heightField = nullptr;
+            rp3d::HeightFieldShape* shape = nullptr;
+            // Streaming pass in which a body last needed the tile
+            std::uint64_t lastNeededPass = 0;
+            // rp3d rejected the tile's heights. They never change, so it is
+            // kept as a marker instead of being rebuilt every batch.
+            bool failed = false;
+        };
+
+        struct Terrain
+        {
+            EntityID entity = INVALID_ENTITY;
+            TerrainComponent component;
+            Vector3 position;
+            ui32 tilesX = 0;
+            ui32 tilesZ = 0;
+            // Keyed by tileZ * tilesX + tileX
+            std::unordered_map<ui32, TerrainTile> tiles;
+        };
+
+        // Streaming passes a tile survives without being needed
+        static constexpr std::uint64_t TILE_EVICT_DELAY = 120;
+
+        struct BodyState
+        {
+            EntityID entity;
+            bool isAwake;
+            Vector3 previousPosition;
+            Quaternion previousRotation;
+            Vector3 position;
+            Quaternion rotation;
+            Vector3 linearVelocity;
+        };
+
+        struct Snapshot
+        {
+            std::uint64_t sequence = 0;
+            // Commands executed before the snapshot was built
+            std::uint64_t commandsApplied = 0;
+            // Accumulated time not yet simulated when the snapshot was built
+            float accumulator = 0.0f;
+            float timeDilation = 1.0f;
+            std::vector<BodyState> bodies;
+            // Every event not yet in a snapshot the main thread took
+            std::vector<CollisionEvent> events;
+        };
+
+        // Run of m_collisionEvents that first went out with a snapshot
+        struct EventBatch
+        {
+            std::uint64_t sequence;
+            size_t count;
+        };
+
+        // Set in m_readySnapshot when it holds a snapshot not yet consumed
+        static constexpr ui32 SNAPSHOT_FRESH = 4;
+
+        // Main-thread side
+        void submit(const Command& command);
+        void applySnapshot(const Snapshot& snapshot, float alpha, bool fresh);
+        bool acquireSnapshot();
+
+        // World-owner side
+        void executeCommand(const Command& command);
+        void createBody(const Command& command);
+        void updateBody(const Command& command);
+        void destroyBody(EntityID entity);
+        static rp3d::BodyType toReactBodyType(PhysicsBodyType type);
+        Body* findBody(EntityID entity);
+        ui32 takeSteps(float deltaTime, float& timeDilation);
+        void runSteps(ui32 steps);
+        void buildSnapshot(Snapshot& snapshot, float timeDilation);
+        void threadMain();
+        void stopThread();
+
+        void runRaycast(RaycastQuery& query);
+
+        bool prepareRecording();
+        void recordCommand(const Command& command);
+        void writeKeyframe();
+        std::uint64_t computeChecksum() const;
+        bool createWorld();
+        // Empties the world and replaces the rp3d world with a new one
+        void resetWorld();
+
+        void createTerrain(const Command& command);
+        void destroyTerrain(EntityID entity);
+        void streamTerrain();
+        void createTerrainTile(Terrain& terrain, ui32 tileX, ui32 tileZ, TerrainTile& tile);
+        void destroyTerrainTile(TerrainTile& tile);
+
+        rp3d::CollisionShape* acquireShape(rp3d::CollisionShapeName name, float a, float b = 0.0f, float c = 0.0f, BakedMesh* mesh = nullptr);
+        void destroyShape(const ShapeKey& key, rp3d::CollisionShape* shape);
+        BakedMesh* bakeMesh(const CollisionMesh& collisionMesh, bool convex);
+        void releaseBakedMesh(BakedMesh* mesh);
 
     private:
+        ComponentManager& m_componentManager;
         rp3d::PhysicsCommon m_physicsCommon;
         rp3d::PhysicsWorld* m_physicsWorld = nullptr;
+        // Whether the rp3d world ever held a body or terrain
+        bool m_worldUsed = false;
+
+        std::vector<Body> m_bodies;
+        std::unordered_map<EntityID, size_t> m_bodyIndex;
+        // Parallel to m_bodies, what each was last created or updated from
+        std::vector<PhysicsComponent> m_bodyComponents;
+
+        std::vector<Terrain> m_terrains;
+        std::vector<float> m_tileHeights;
+        std::uint64_t m_streamPass = 0;
+
+        std::unordered_map<ShapeKey, CachedShape, ShapeKeyHash> m_shapeCache;
+        std::unordered_map<const rp3d::CollisionShape*, ShapeKey> m_shapeKeys;
+        std::unordered_map<std::string, BakedMesh> m_meshCache;
+
+        // Set from the main thread, read by the physics thread
+        std::atomic<float> m_fixedTimeStep{ 1.0f / 60.0f }; // 60 FPS
+        std::atomic<ui32> m_maxSubsteps{ 4 };
+        std::atomic<bool> m_interpolationEnabled{ true };
 
-        float m_fixedTimeStep = 1.0f / 60.0f; // 60 FPS
         float m_accumulator = 0.0f;
+        float m_timeDilation = 1.0f;
+        float m_interpolationAlpha = 0.0f;
+
+        // Snapshots: only m_readSnapshot is used inline. When threaded the
+        // physics thread fills m_writeSnapshot, swaps it with the index in
+        // m_readySnapshot, and the main thread swaps that with m_readSnapshot.
+        Snapshot m_snapshots[3];
+        ui32 m_writeSnapshot = 1;
+        ui32 m_readSnapshot = 0;
+        std::atomic<ui32> m_readySnapshot{ 2 };
+        std::atomic<std::uint64_t> m_consumedSequence{ 0 };
+        std::uint64_t m_sequence = 0;
+        float m_timeSinceSnapshot = 0.0f;
+
+        // Commands are counted on both sides, so a snapshot built before a
+        // teleport was executed can be told apart from one built after it
+        std::uint64_t m_commandsSubmitted = 0;
+        std::uint64_t m_commandsApplied = 0;
+        std::unordered_map<EntityID, std::uint64_t> m_pendingTeleports;
+
+        // Filled by the event listener during steps and trimmed once the
+        // main thread has taken the snapshots that carried them. Capacity
+        // is kept, so a steady stream of contacts does not allocate.
+        std::unique_ptr<rp3d::EventListener> m_eventListener;
+        std::vector<CollisionEvent> m_collisionEvents;
+        std::vector<EventBatch> m_eventBatches;
+        size_t m_batchedEventCount = 0;
+        std::atomic<ui32> m_eventFilter{ ~0u };
+        bool m_eventsFresh = false;
+        std::vector<CollisionEvent> m_noEvents;
+
+        // Written by the thread that owns the world; m_recording is whether
+        // it is currently recording, which lags the flag until the next
+        // command or step
+        PhysicsRecorder m_recorder;
+        bool m_recording = false;
+        std::atomic<bool> m_recordingEnabled{ true };
+        std::atomic<size_t> m_recordingBudget{ PhysicsRecorder::DEFAULT_BUDGET };
+
+        // Physics thread and its inbox, guarded by m_commandMutex
+        std::thread m_thread;
+        std::mutex m_commandMutex;
+        std::condition_variable m_commandSignal;
+        std::vector<Command> m_pendingCommands;
+        float m_pendingTime = 0.0f;
+        ui32 m_pendingSteps = 0;
+        bool m_stopRequested = false;
 
         bool m_initialized = false;
     };
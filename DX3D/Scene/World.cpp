@@ -0,0 +1,57 @@
+#include <../Scene/World.h>
+#include <../Particles/ParticleSystem.h>
+
+using namespace dx3d;
+
+namespace
+{
+    thread_local World* t_currentWorld = nullptr;
+}
+
+World::World() :
+    m_physicsSystem(m_componentManager),
+    m_particleSystem(std::make_unique<ParticleSystem>())
+{
+}
+
+World::~World()
+{
+    m_physicsSystem.shutdown();
+}
+
+World& World::getDefault()
+{
+    static World instance;
+    return instance;
+}
+
+World& World::getCurrent()
+{
+    return t_currentWorld ? *t_currentWorld : getDefault();
+}
+
+World::Scope::Scope(World& world) :
+    m_previous(t_currentWorld)
+{
+    t_currentWorld = &world;
+}
+
+World::Scope::~Scope()
+{
+    t_currentWorld = m_previous;
+}
+
+ComponentManager& ComponentManager::getInstance()
+{
+    return World::getCurrent().getComponentManager();
+}
+
+PhysicsSystem& PhysicsSystem::getInstance()
+{
+    return World::getCurrent().getPhysicsSystem();
+}
+
+ParticleSystem& ParticleSystem::getInstance()
+{
+    return World::getCurrent().getParticleSystem();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <../ECS/ComponentManager.h>
+#include <../ECS/TransformHierarchy.h>
+#include <../Physics/PhysicsSystem.h>
+#include <memory>
+
+namespace dx3d
+{
+    class ParticleSystem;
+
+    // Owns one independent simulation: component pools, the transform
+    // hierarchy pass, physics world and particle emitters. The editor runs in
+    // the default world; background bakes, headless benchmarks and tests
+    // create their own and can run them on other threads concurrently.
+    //
+    // The legacy getInstance() accessors of ComponentManager, PhysicsSystem
+    // and ParticleSystem resolve to the calling thread's current world, which
+    // is the default world unless a World::Scope is active. New systems should
+    // take the world (or its parts) by reference instead.
+    class World
+    {
+    public:
+        World();
+        ~World();
+
+        World(const World&) = delete;
+        World& operator=(const World&) = delete;
+
+        ComponentManager& getComponentManager() { return m_componentManager; }
+        const ComponentManager& getComponentManager() const { return m_componentManager; }
+        TransformHierarchy& getTransformHierarchy() { return m_transformHierarchy; }
+        const TransformHierarchy& getTransformHierarchy() const { return m_transformHierarchy; }
+        PhysicsSystem& getPhysicsSystem() { return m_physicsSystem; }
+        ParticleSystem& getParticleSystem() { return *m_particleSystem; }
+
+        static World& getDefault();
+        static World& getCurrent();
+
+        // Makes a world current on this thread for the lifetime of the scope
+        class Scope
+        {
+        public:
+            explicit Scope(World& world);
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            World* m_previous;
+        };
+
+    private:
+        // Declaration order matters: physics bodies are destroyed before the
+        // pools that reference them.
+        ComponentManager m_componentManager;
+        TransformHierarchy m_transformHierarchy;
+        PhysicsSystem m_physicsSystem;
+        std::unique_ptr<ParticleSystem> m_particleSystem;
+    };
+}
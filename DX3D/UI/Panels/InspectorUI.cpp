@@ -82,7 +82,8 @@ void InspectorUI::render()
 void InspectorUI::renderObjectInfo(std::shared_ptr<AGameObject> object)
 {
     ImGui::Text("Type: %s", object->getObjectType().c_str());
-    ImGui::Text("Entity ID: %u", object->getEntity().getID());
+    const Entity& entity = object->getEntity();
+    ImGui::Text("Entity ID: %u (index %u, gen %u)", entity.getID(), entity.getIndex(), entity.getGeneration());
 
     bool enabled = object->isEnabled();
     if (ImGui::Checkbox("Enabled", &enabled))
@@ -467,10 +468,12 @@ void InspectorUI::renderPhysics(std::shared_ptr<AGameObject> object)
 
     if (!physicsComp) return;
 
-    // Display physics properties
-    ImGui::Text("Body Type: %s",
-        physicsComp->bodyType == PhysicsBodyType::Static ? "Static" :
-        physicsComp->bodyType == PhysicsBodyType::Kinematic ? "Kinematic" : "Dynamic");
+    const char* bodyTypes[] = { "Static", "Kinematic", "Dynamic" };
+    int bodyType = static_cast<int>(physicsComp->bodyType);
+    if (ImGui::Combo("Body Type", &bodyType, bodyTypes, 3))
+    {
+        object->setPhysicsBodyType(static_cast<PhysicsBodyType>(bodyType));
+    }
 
     if (physicsComp->bodyType == PhysicsBodyType::Dynamic)
     {
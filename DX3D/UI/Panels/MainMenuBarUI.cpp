@@ -195,6 +195,12 @@ void MainMenuBarUI::render(const Callbacks& callbacks)
                         callbacks.onSpawnModel("lucy.obj");
                 }
 
+                if (ImGui::MenuItem("Terrain", nullptr, false, isEditMode))
+                {
+                    if (callbacks.onSpawnModel)
+                        callbacks.onSpawnModel("terrain.obj");
+                }
+
                 ImGui::EndMenu();
             }
 
@@ -2,6 +2,7 @@
 #include <../UI/UIController.h>
 #include <../Scene/SceneStateManager.h>
 #include <../Game/UndoRedoSystem.h>
+#include <../Physics/PhysicsSystem.h>
 #include <../Core/Logger.h>
 #include <imgui.h>
 
@@ -91,6 +92,22 @@ void SceneControlsUI::render()
         ImGui::PopStyleVar();
     }
 
+    ImGui::SameLine();
+
+    auto& physicsSystem = PhysicsSystem::getInstance();
+    bool threadedPhysics = physicsSystem.isThreaded();
+    if (ImGui::Checkbox("Threaded Physics", &threadedPhysics))
+    {
+        physicsSystem.setThreaded(threadedPhysics);
+    }
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("Save Physics Log"))
+    {
+        physicsSystem.saveRecording("physics_recording.dxpr");
+    }
+
     if (m_sceneStateManager.isEditMode())
     {
         ImGui::Separator();
@@ -153,11 +153,6 @@ void SceneOutlinerUI::renderObjectNode(std::shared_ptr<AGameObject> object, int&
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.5f, 0.5f, 0.5f, 1.0f));
     }
 
-    if (object->getChildren().empty())
-    {
-        nodeFlags |= ImGuiTreeNodeFlags_Leaf;
-    }
-
     bool nodeOpen = ImGui::TreeNodeEx(nodeName.c_str(), nodeFlags);
 
     if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen())
@@ -210,19 +205,9 @@ void SceneOutlinerUI::renderObjectNode(std::shared_ptr<AGameObject> object, int&
 
     if (nodeOpen)
     {
-        int validChildCount = 0;
-        for (auto& weakChild : object->getChildren())
-        {
-            if (auto child = weakChild.lock())
-            {
-                validChildCount++;
-                renderObjectNode(child, nodeIndex);
-            }
-        }
-
-        if (!object->getChildren().empty() && validChildCount == 0)
+        for (const auto& child : object->getChildren())
         {
-            ImGui::TextDisabled("  (Children are invalid or destroyed)");
+            renderObjectNode(child, nodeIndex);
         }
 
         ImGui::TreePop();